@@ -1,28 +1,92 @@
+#define _GNU_SOURCE // accept4
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #define MAX_NAME_LEN 100
 #define MAX_ISBN_LEN 20
 #define MAX_DATE_LEN 11 // DD.MM.YYYY + null terminator
+#define LOAN_PERIOD_DAYS 14
+#define LOAN_ARCHIVE_DAYS 365 // Age after which returned loans move to the archive
+#define ARCHIVE_DIR "arsiv"
 #define MAX_LINE_LEN 256
+#define MAX_SEARCH_RESULTS 20 // Matches listed by the name searches
+#define MAX_SUGGESTIONS 5 // Similar names offered when a name search finds nothing
+
+// Status codes of the table operations (insertBook, closeLoan, ...)
+#define OP_OK 0
+#define OP_NOT_FOUND 1
+#define OP_DUPLICATE 2 // ID, ISBN or link already present
+#define OP_IN_USE 3 // Book has borrowed examples or student has active loans
+#define OP_UNAVAILABLE 4 // Example is not on the shelf
+#define OP_RETURNED 5 // Loan was already returned
+#define OP_NO_MEMORY 6
+#define OP_BAD_REQUEST 7 // Batch command that cannot be parsed, or an ISBN that cannot be stored
+#define CSV_MAX_FIELDS 8
+#define SNAPSHOT_FILE "kutuphane.snap"
+#define SNAPSHOT_MAGIC "KTPHSNAP" // 8 bytes, no terminator stored
+#define SNAPSHOT_VERSION 1
+#define OUT_FLUSH_SIZE (1024 * 1024) // Output buffer size that triggers a write
+#define OUT_ROW_MAX (2 * MAX_NAME_LEN + 128) // Longest formatted CSV row
+#define SAVE_CHUNK_ROWS 65536 // Loans formatted per task when saving
+#define SAVE_MAX_THREADS 8
+#define JOURNAL_FILE "kutuphane.wal"
+#define JOURNAL_MAGIC "KTPHWAL1"
+#define JOURNAL_HEADER_SIZE 8 // The magic, without terminator
+#define JOURNAL_SYNC_RECORDS 256 // Records per fdatasync at most
+#define JOURNAL_SYNC_SECONDS 1 // Age of the oldest unsynced record at most
+#define LOCK_FILE "kutuphane.lock" // Held while a process uses the data files
+#define SERVER_SOCKET "kutuphane.sock" // Default socket of --serve
+#define SERVER_WORKERS 4
+#define SERVER_MAX_REQUEST 1024 // Longest request payload accepted
+#define SERVER_MAX_RESPONSE (MAX_LINE_LEN + 32) // Longest response payload
+#define SERVER_MAX_EVENTS 64 // epoll events handled per wakeup
+#define BULK_MAX_RANGE 1000000 // IDs one first-last range of DELETE_MANY may span
+#define LINK_MAX_PENDING 256 // Links added since the last link index rebuild that queries scan instead
+#define STRESS_THREADS 8
+#define STRESS_ROUNDS 200000 // Claims each --stress thread attempts
+#define JOURNAL_CHECKPOINT_BYTES (8 * 1024 * 1024) // Journal size that triggers a checkpoint
+#define JOURNAL_MAX_PAYLOAD 512
 
 // Structure definitions
 typedef struct Book {
     int bookId;
     char bookName[MAX_NAME_LEN];
     char ISBN[MAX_ISBN_LEN];
-    struct BookExample *head; 
+    int exampleCount;
+    int availableCount; // Examples currently on the shelf
+    // Example status bitmap, bit (exampleId - 1) set: Borrowed, clear: On Shelf.
+    // Books with up to 64 examples keep it inline. Once the tables are loaded
+    // the bits and availableCount only change through claimBookExample and
+    // releaseBookExample, which update them atomically.
+    union {
+        uint64_t inlineBits;
+        uint64_t *bits;
+    } examples;
     struct Book *next;
 } Book;
 
-typedef struct BookExample {
-    int exampleId;
-    int status; // 0: On Shelf, 1: Borrowed
-    struct BookExample *next;
-} BookExample;
-
 typedef struct Author {
     int authorId;
     char authorName[MAX_NAME_LEN];
@@ -40,6 +104,8 @@ typedef struct Student {
     char studentName[MAX_NAME_LEN];
     int penaltyDays;
     struct Student *next;
+    struct Student *prevPenalized; // Students with penalty days (see penalizedHead)
+    struct Student *nextPenalized;
 } Student;
 
 typedef struct BookLoan {
@@ -47,1434 +113,8327 @@ typedef struct BookLoan {
     int bookId;
     int exampleId;
     int studentId;
-    char loanDate[MAX_DATE_LEN];
-    char returnDate[MAX_DATE_LEN]; // Expected return date
+    int32_t loanDay; // Dates are day numbers, days since 01.01.1970
+    int32_t returnDay; // Expected return date, the due-date heap key
     int returned; // 0: Not returned, 1: Returned
     struct BookLoan *next;
+    struct BookLoan *nextByStudent; // Student's loan history, newest first
+    struct BookLoan *nextByExample; // Example's loan history, newest first
+    struct BookLoan *prevActive; // Student's active loans, oldest first
+    struct BookLoan *nextActive;
+    int heapPos; // Position in the due-date heap, -1 if not in it
 } BookLoan;
 
+// Min-heap of the active loans ordered by due date
+typedef struct LoanHeap {
+    BookLoan **loans;
+    size_t count;
+    size_t capacity;
+} LoanHeap;
+
+// Loans of one student or one book example (see the loan indexes)
+typedef struct LoanChain {
+    BookLoan *history; // Every loan, newest first
+    BookLoan *activeHead; // Loans not yet returned (students only)
+    BookLoan *activeTail;
+    int activeCount;
+} LoanChain;
+
+// Open-addressing hash index from a 64-bit key to a node pointer
+typedef struct HashIndex {
+    uint64_t *keys;
+    void **values; // NULL marks an empty slot
+    size_t capacity; // Always zero or a power of two
+    size_t count;
+} HashIndex;
+
+// Slab allocator for the nodes of one table. Nodes are carved out of large
+// chunks in allocation order; deleted nodes go on a free list for reuse.
+typedef struct NodePool {
+    size_t nodeSize;
+    size_t nextChunkNodes; // Size of the next chunk, doubling up to a cap
+    char **chunks;
+    size_t chunkCount;
+    size_t chunkCapacity;
+    size_t chunkNodes; // Capacity of the newest chunk
+    size_t chunkUsed; // Nodes handed out from the newest chunk
+    void *freeList;
+} NodePool;
+
+// Entry of a sorted name index
+typedef struct NameEntry {
+    char *key; // Case-folded name (see foldName)
+    void *node;
+} NameEntry;
+
+// Name index sorted by folded key. Equal keys keep their insertion order.
+typedef struct NameIndex {
+    NameEntry *entries;
+    size_t count;
+    size_t capacity;
+} NameIndex;
+
+#define POSTING_INLINE_BYTES 8
+
+// Posting list of a word index: the IDs whose name has the word, ascending,
+// stored as varint-encoded gaps (see postingAppend)
+typedef struct Posting {
+    union {
+        unsigned char inlineBytes[POSTING_INLINE_BYTES]; // While capacity is 0
+        unsigned char *bytes;
+    } data;
+    uint32_t size;
+    uint32_t capacity;
+    int count;
+    int lastId; // Base of the next appended gap
+    unsigned char marked; // Queued by wordIndexRemoveNodes
+    char word[]; // Folded word (see nextWord)
+} Posting;
+
+// Posting lists a bulk removal has touched, each filtered once at the end
+// (see postingBatchStart)
+typedef struct PostingBatch {
+    int *doomed; // IDs to remove, ascending
+    size_t doomedCount;
+    Posting **touched;
+    size_t touchedCount;
+    size_t touchedCapacity;
+} PostingBatch;
+
+// Trigram index over the names of one table (see trigramIndexSearch).
+// The first fuzzy search of the table builds it from the ID index; from
+// then on the add/update/delete functions keep it up to date.
+typedef struct TrigramIndex {
+    HashIndex trigrams; // Trigram key -> Posting
+    const HashIndex *ids; // ID index of the table
+    size_t nameOffset; // Of the name in a node
+    int built;
+} TrigramIndex;
+
+// A node with its ID, for sorting the nodes of an ID index
+typedef struct IdNode {
+    int id;
+    void *node;
+} IdNode;
+
+// The books one search word finds: titleIds by title, ids by title or by
+// one of the book's authors. Both ascending.
+typedef struct WordHits {
+    int *titleIds;
+    int titleCount;
+    int *ids;
+    int count;
+} WordHits;
+
+// One row of a LinkIndex: the linked IDs of one book (or author) are
+// columns[start] .. columns[start + count - 1]
+typedef struct LinkRow {
+    int id;
+    int start;
+    int count;
+} LinkRow;
+
+// Book-author links in compressed sparse row form, in one direction
+typedef struct LinkIndex {
+    LinkRow *rows;
+    int rowCount;
+    int *columns; // Sorted within each row
+    HashIndex rowIndex; // Row ID -> LinkRow
+} LinkIndex;
+
+// Memory-mapped CSV file split into records in place (see csvNextRecord).
+// Fields point into the mapping and are not null-terminated.
+typedef struct CsvReader {
+    const char *fileName;
+    const char *data;
+    size_t size;
+    size_t pos; // Start of the next line
+    int lineNumber; // 1-based number of the current line
+    const char *fields[CSV_MAX_FIELDS];
+    size_t lengths[CSV_MAX_FIELDS];
+    int fieldCount;
+    int malformed; // Lines reported by csvReportMalformed
+} CsvReader;
+
+// Snapshot file structures (see the Snapshot Functions section). The
+// section table has one entry per section type, in type order.
+#define SNAPSHOT_BOOKS 0
+#define SNAPSHOT_EXAMPLES 1 // Example bitmap words of every book, in book order
+#define SNAPSHOT_AUTHORS 2
+#define SNAPSHOT_STUDENTS 3
+#define SNAPSHOT_LOANS 4
+#define SNAPSHOT_BOOK_AUTHORS 5
+#define SNAPSHOT_STRINGS 6
+#define SNAPSHOT_SECTION_COUNT 7
+
+typedef struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    int32_t nextBookId;
+    int32_t nextAuthorId;
+    int32_t nextStudentId;
+    int32_t nextLoanId;
+    uint32_t tableCrc; // CRC32C of the section table
+    int32_t lastPenaltyDay; // See lastPenaltyDay; 0 in snapshots written before it existed
+} SnapshotHeader;
+
+typedef struct SnapshotSection {
+    uint32_t type;
+    uint32_t recordSize;
+    uint64_t offset; // From the start of the file, a multiple of 8
+    uint64_t count; // Number of records
+    uint32_t crc; // CRC32C of the section data
+    uint32_t reserved;
+} SnapshotSection;
+
+typedef struct SnapshotBook {
+    int32_t bookId;
+    int32_t exampleCount;
+    uint32_t nameOffset; // String heap offsets
+    uint32_t isbnOffset;
+} SnapshotBook;
+
+typedef struct SnapshotAuthor {
+    int32_t authorId;
+    uint32_t nameOffset;
+} SnapshotAuthor;
+
+typedef struct SnapshotStudent {
+    int32_t studentId;
+    int32_t penaltyDays;
+    uint32_t nameOffset;
+} SnapshotStudent;
+
+typedef struct SnapshotLoan {
+    int32_t loanId;
+    int32_t bookId;
+    int32_t exampleId;
+    int32_t studentId;
+    int32_t loanDay;
+    int32_t returnDay;
+    int32_t returned;
+} SnapshotLoan;
+
+typedef struct SnapshotBookAuthor {
+    int32_t bookId;
+    int32_t authorId;
+} SnapshotBookAuthor;
+
+// Reusable output buffer of the save functions (see outReserve)
+typedef struct OutBuffer {
+    char *data;
+    size_t size;
+    size_t capacity;
+} OutBuffer;
+
+// A run of consecutive loans formatted by one save thread
+typedef struct LoanChunk {
+    BookLoan *first;
+    size_t rows;
+    OutBuffer out;
+    int failed;
+} LoanChunk;
+
+// One table to save on a checkpoint thread (see checkpointTables)
+typedef struct SaveJob {
+    unsigned table; // TABLE_* flag
+    const char *fileName;
+    Book *bookHead;
+    Author *authorHead;
+    Student *studentHead;
+    BookLoan *loanHead;
+    BookAuthor *bookAuthorArray;
+    int bookAuthorCount;
+    int status; // Result of the save function
+} SaveJob;
+
+// Validated sections of a mapped snapshot file (see loadSnapshot)
+typedef struct SnapshotView {
+    const SnapshotBook *books;
+    const uint64_t *words;
+    const SnapshotAuthor *authors;
+    const SnapshotStudent *students;
+    const SnapshotLoan *loans;
+    const SnapshotBookAuthor *links;
+    const char *heap;
+    size_t bookCount;
+    size_t authorCount;
+    size_t studentCount;
+    size_t loanCount;
+    size_t linkCount;
+} SnapshotView;
+
+// One table to load on a startup thread (see loadTables)
+typedef struct LoadJob {
+    unsigned table; // TABLE_* flag
+    const SnapshotView *snapshot; // NULL to import the CSV file
+    Book **bookHead;
+    Author **authorHead;
+    Student **studentHead;
+    BookLoan **loanHead;
+    BookAuthor **bookAuthorArray;
+    int *bookAuthorCount;
+} LoadJob;
+
+// Rows to delete together with deleteBatchRun, keyed by ID with the row
+// as value, and what the run removed
+typedef struct DeleteBatch {
+    HashIndex books;
+    HashIndex authors;
+    HashIndex students;
+    int deletedBooks;
+    int deletedAuthors;
+    int deletedStudents;
+    int removedLinks;
+} DeleteBatch;
+
+// A client connected to the server (see runServer). The event loop owns
+// the connection; while busy is set, a worker owns request and out.
+typedef struct Connection {
+    int fd;
+    uint32_t events; // epoll interest, 0 once removed from epoll
+    int busy; // A request is with the workers
+    int closing; // Peer closed or failed, close once idle
+    char in[4 + SERVER_MAX_REQUEST]; // Received bytes not yet dispatched
+    size_t inSize;
+    char out[4 + SERVER_MAX_RESPONSE]; // Framed response being sent
+    size_t outSize;
+    size_t outSent;
+    char request[SERVER_MAX_REQUEST + 1]; // Command of the busy request
+    struct Connection *nextJob; // Work queue or answered list
+    struct Connection *prev; // All connections, for shutdown
+    struct Connection *next;
+} Connection;
+
+// Tables a batch command reads and changes (see batchCommandTables)
+typedef struct CommandTables {
+    const char *command;
+    unsigned readTables;
+    unsigned writeTables;
+} CommandTables;
+
+// One thread of the example claim stress test (see runStress)
+typedef struct StressJob {
+    Book *books; // Hot books shared by all threads
+    int bookCount;
+    int **holders; // Per book and example: threads holding it right now
+    unsigned seed;
+    long claims; // Successful claims
+    long refused; // Claims that found the example taken
+    long errors; // Examples held twice and failed releases
+} StressJob;
+
+// State shared by the server's event loop and its workers
+typedef struct Server {
+    Book *bookHead;
+    Author *authorHead;
+    Student *studentHead;
+    BookLoan *loanHead;
+    BookAuthor *bookAuthorArray;
+    int bookAuthorCount;
+    pthread_mutex_t queueLock; // Protects the fields below
+    pthread_cond_t queueReady;
+    Connection *queueHead; // Requests waiting for a worker
+    Connection *queueTail;
+    Connection *answered; // Requests a worker has answered
+    int stopping;
+    int wakeFd; // eventfd, signalled when a request is answered
+    Connection *connections; // Owned by the event loop
+} Server;
+
+// Growable string heap used while writing a snapshot
+typedef struct StringHeap {
+    char *data;
+    size_t size;
+    size_t capacity;
+} StringHeap;
+
+// Table flags for dirty tracking and table locks. The bit order is the
+// lock order (see the Table Lock Functions section).
+#define TABLE_BOOKS 0x01
+#define TABLE_AUTHORS 0x02
+#define TABLE_STUDENTS 0x04
+#define TABLE_LOANS 0x08
+#define TABLE_LINKS 0x10
+#define TABLE_ALL 0x1F
+#define TABLE_COUNT 5
+
+// Journal record types (see the Journal Functions section)
+#define JOURNAL_BOOK_PUT 1
+#define JOURNAL_BOOK_DELETE 2
+#define JOURNAL_AUTHOR_PUT 3
+#define JOURNAL_AUTHOR_DELETE 4
+#define JOURNAL_STUDENT_PUT 5
+#define JOURNAL_STUDENT_DELETE 6
+#define JOURNAL_LOAN_ADD 7
+#define JOURNAL_LOAN_RETURN 8
+#define JOURNAL_LINK_ADD 9
+#define JOURNAL_PENALTY_TICK 10
+
+// Open journal and the records not yet written to it
+typedef struct Journal {
+    int fd; // -1 while closed
+    char buffer[64 * 1024];
+    size_t size; // Buffered bytes
+    size_t fileSize; // Bytes of records in the file
+    int unsynced; // Records since the last fdatasync
+    time_t lastSync;
+    int replaying; // Set while replaying, suppresses logging
+} Journal;
+
+// One pool per table
+static NodePool bookPool = { .nodeSize = sizeof(Book) };
+static NodePool authorPool = { .nodeSize = sizeof(Author) };
+static NodePool studentPool = { .nodeSize = sizeof(Student) };
+static NodePool loanPool = { .nodeSize = sizeof(BookLoan) };
+static NodePool loanChainPool = { .nodeSize = sizeof(LoanChain) };
+
+// Number of books whose example bitmap is allocated out of line
+static int wideBookCount;
+
+// ID indexes, kept up to date by the load/add/delete functions
+static HashIndex bookIdIndex;
+static HashIndex authorIdIndex;
+static HashIndex studentIdIndex;
+static HashIndex loanIdIndex;
+
+// Loan indexes: studentId -> LoanChain and (bookId, exampleId) -> LoanChain,
+// maintained by loadBookLoans, addBookLoan and returnBook
+static HashIndex studentLoanIndex;
+static HashIndex exampleLoanIndex;
+
+// Active loans by due date, maintained alongside the loan indexes
+static LoanHeap dueHeap;
+
+// Name indexes, kept up to date by the load/add/update/delete functions
+static NameIndex bookNameIndex;
+static NameIndex authorNameIndex;
+static NameIndex studentNameIndex;
+
+// Word indexes (folded word -> Posting) over book titles and author names.
+// The first word search builds them under wordIndexLock; from then on the
+// add/update/delete functions keep them up to date.
+static HashIndex bookWordIndex;
+static HashIndex authorWordIndex;
+static int wordIndexesBuilt;
+static pthread_mutex_t wordIndexLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Trigram indexes for the fuzzy name searches, built under trigramIndexLock
+static TrigramIndex bookTrigramIndex = { { NULL, NULL, 0, 0 }, &bookIdIndex, offsetof(Book, bookName), 0 };
+static TrigramIndex authorTrigramIndex = { { NULL, NULL, 0, 0 }, &authorIdIndex, offsetof(Author, authorName), 0 };
+static TrigramIndex studentTrigramIndex = { { NULL, NULL, 0, 0 }, &studentIdIndex, offsetof(Student, studentName), 0 };
+static pthread_mutex_t trigramIndexLock = PTHREAD_MUTEX_INITIALIZER;
+
+// List tails, so that inserts append without walking the list
+static Book *bookTail;
+static Author *authorTail;
+static Student *studentTail;
+static BookLoan *loanTail;
+
+// Next ID to hand out per table. Persisted in sayaclar.csv and never moved
+// backwards, so an ID freed by a delete is not reused.
+static int nextBookId = 1;
+static int nextAuthorId = 1;
+static int nextStudentId = 1;
+static int nextLoanId = 1;
+
+// Students with penalty days, in the order they got them, kept up to date
+// by setStudentPenalty and the student load and delete functions
+static Student *penalizedHead;
+static Student *penalizedTail;
+
+// Day of the last penalty tick; late days up to it have been charged for
+// every active loan. 0 before the first tick. Persisted in sayaclar.csv
+// and the snapshot header.
+static int32_t lastPenaltyDay;
+
+// When the next penalty tick is due: the coming local midnight
+static time_t nextPenaltyTick;
+
+// ISBN index keyed by the normalized 13-digit ISBN (see isbnKey)
+static HashIndex isbnIndex;
+
+// Book-author link indexes, all derived from the link array. linkSet holds
+// every link (see linkKey) and, once built, is kept up to date by the link
+// functions. The CSR indexes cover the first linkIndexedCount links; later
+// adds are scanned by queries until there are more than LINK_MAX_PENDING,
+// and deletes or more adds make the next query rebuild them.
+static int bookAuthorCapacity; // Allocated size of the link array
+static HashIndex linkSet;
+static int linkSetBuilt;
+static char linkPresent; // Value stored in linkSet, only the keys matter
+static LinkIndex authorsByBook;
+static LinkIndex booksByAuthor;
+static int linkIndexesBuilt;
+static int linkIndexedCount;
+static pthread_mutex_t linkIndexLock = PTHREAD_MUTEX_INITIALIZER; // Serializes lazy rebuilds
+
+// Serializes recording new loans, which borrows do under a read lock on
+// loans (see insertLoan); taken after the table locks
+static pthread_mutex_t loanInsertLock = PTHREAD_MUTEX_INITIALIZER;
+
+static Journal journal = { .fd = -1 };
+// Serializes the journal between threads; taken after any table locks
+static pthread_mutex_t journalLock = PTHREAD_MUTEX_INITIALIZER;
+
+// One reader-writer lock per table, indexed by TABLE_* bit. Writers are
+// preferred so that a steady stream of readers cannot starve them.
+static pthread_rwlock_t tableLocks[TABLE_COUNT] = {
+    PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP, PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP,
+    PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP, PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP,
+    PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP
+};
+
+// Tables changed since they were last written to their CSV file and to
+// the snapshot. The snapshot starts out dirty until it is loaded or saved.
+static unsigned csvDirtyTables;
+static unsigned snapshotDirtyTables = TABLE_ALL;
+
+// Tables whose CSV file had malformed lines when it was loaded. The file
+// is kept as "<name>.bak" before it is first rewritten without them.
+static unsigned csvSkippedTables;
+
 // Function prototypes 
 void printMenu();
 void loadBooks(Book **bookHead);
-void saveBooks(Book *bookHead);
+int linkLoadedBook(Book *newBook, Book **bookHead, Book **last);
+int saveBooks(Book *bookHead);
 void addBook(Book **bookHead);
-void deleteBook(Book **bookHead, BookLoan *loanHead);
+int insertBook(Book **bookHead, int bookId, const char *bookName, const char *ISBN, int exampleCount, Book **result);
+int removeBook(Book **bookHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int bookId);
+int setBookDetails(Book *bookHead, int bookId, const char *bookName, const char *ISBN);
+void deleteBook(Book **bookHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
 void updateBook(Book *bookHead);
 void printBooks(Book *bookHead);
 Book *findBookById(Book *bookHead, int bookId);
 Book *findBookByISBN(Book *bookHead, const char *ISBN);
+uint64_t isbnKey(const char *ISBN);
+int isbnStorable(const char *ISBN);
 Book *findBookByName(Book *bookHead, const char *bookName);
-void createBookExamples(Book *bookHead);
+void searchBooksByName(Book *bookHead, const char *bookName);
+void searchBooksByWords(Book *bookHead, Author *authorHead, const BookAuthor *bookAuthorArray, int bookAuthorCount,
+                        const char *query);
+int createBookExamples(Book *book, int exampleCount);
+void freeBookExamples(Book *book);
+int getBookExampleStatus(const Book *book, int exampleId);
+int claimBookExample(Book *book, int exampleId);
+int releaseBookExample(Book *book, int exampleId);
 void printBookExamples(Book *bookHead);
 void printBookExamplesByBookName(Book *bookHead);
-void updateBookExampleStatus(Book *bookHead, int bookId, int exampleId, int status);
 
 void loadAuthors(Author **authorHead);
-void saveAuthors(Author *authorHead);
+int linkLoadedAuthor(Author *newAuthor, Author **authorHead, Author **last);
+int saveAuthors(Author *authorHead);
 void addAuthor(Author **authorHead);
+int insertAuthor(Author **authorHead, int authorId, const char *authorName, Author **result);
+int removeAuthor(Author **authorHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int authorId);
+int setAuthorName(Author *authorHead, int authorId, const char *authorName);
 void deleteAuthor(Author **authorHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int deletedAuthorId);
 void updateAuthor(Author *authorHead);
 void printAuthors(Author *authorHead);
 Author *findAuthorById(Author *authorHead, int authorId);
 Author *findAuthorByName(Author *authorHead, const char *authorName);
+void searchAuthorsByName(Author *authorHead, const char *authorName);
 
 void loadBookAuthors(BookAuthor **bookAuthorArray, int *count);
-void saveBookAuthors(BookAuthor *bookAuthorArray, int count);
-void addBookAuthor(BookAuthor **bookAuthorArray, int *count, int bookId, int authorId);
+int saveBookAuthors(BookAuthor *bookAuthorArray, int count);
+int addBookAuthor(BookAuthor **bookAuthorArray, int *count, int bookId, int authorId);
 void updateBookAuthor(BookAuthor *bookAuthorArray, int count);
 void printBookAuthors(BookAuthor *bookAuthorArray, int count);
-void updateBookAuthorAfterAuthorDeletion(BookAuthor **bookAuthorArray, int bookAuthorCount, int authorId);
-void updateBookAuthorAfterBookDeletion(BookAuthor **bookAuthorArray, int bookAuthorCount, int bookId);
+void resetBookAuthorIndexes(int capacity);
+int getAuthorsOfBook(const BookAuthor *bookAuthorArray, int count, int bookId, int *authorIds, int maxIds);
+int getBooksByAuthor(const BookAuthor *bookAuthorArray, int count, int authorId, int *bookIds, int maxIds);
+void printAuthorsOfBook(const BookAuthor *bookAuthorArray, int count, int bookId);
+void printBooksByAuthor(const BookAuthor *bookAuthorArray, int count, int authorId);
 
 
 void loadStudents(Student **studentHead);
-void saveStudents(Student *studentHead);
+int linkLoadedStudent(Student *newStudent, Student **studentHead, Student **last);
+int saveStudents(Student *studentHead);
 void addStudent(Student **studentHead);
-void deleteStudentById(Student **studentHead, BookLoan *loanHead);
-void deleteStudentByName(Student **studentHead, BookLoan *loanHead);
+int insertStudent(Student **studentHead, int studentId, const char *studentName, int penaltyDays, Student **result);
+int removeStudent(Student **studentHead, int studentId);
+
+int deleteBatchAdd(DeleteBatch *batch, unsigned table, int id);
+void deleteBatchRun(DeleteBatch *batch, Book **bookHead, Author **authorHead, Student **studentHead,
+                    BookAuthor **bookAuthorArray, int *bookAuthorCount);
+void deleteBatchFree(DeleteBatch *batch);
+int setStudentName(Student *studentHead, int studentId, const char *studentName);
+void deleteStudentById(Student **studentHead);
+void deleteStudentByName(Student **studentHead);
 void updateStudent(Student *studentHead);
 void printStudents(Student *studentHead);
 Student *findStudentById(Student *studentHead, int studentId);
 Student *findStudentByName(Student *studentHead, const char *studentName);
+void searchStudentsByName(Student *studentHead, const char *studentName);
 void printStudentInfo(Student *studentHead, BookLoan *loanHead);
 void printStudentBookLoans(BookLoan *loanHead, int studentId);
 void printStudentsWithPenalty(Student *studentHead);
 
 
 void loadBookLoans(BookLoan **loanHead);
-void saveBookLoans(BookLoan *loanHead);
+int parseLoanRecord(CsvReader *reader, BookLoan *loan);
+int linkLoadedLoan(BookLoan *newLoan, BookLoan **loanHead, BookLoan **last);
+int saveBookLoans(BookLoan *loanHead);
+void *formatLoanChunk(void *arg);
+char *outLoanRow(char *p, const BookLoan *loan);
 void addBookLoan(BookLoan **loanHead, Book *bookHead);
 void returnBook(BookLoan **loanHead, Book *bookHead);
+int insertLoan(BookLoan **loanHead, Book *bookHead, int loanId, int studentId, int bookId, int exampleId,
+               int32_t loanDay, int32_t returnDay, BookLoan **result);
+int closeLoan(Book *bookHead, int loanId, int32_t day);
 void printBookLoans(BookLoan *loanHead);
 void printOverdueLoans(BookLoan *loanHead);
+void printLoansDueWithin(BookLoan *loanHead, int days);
 int isBookReturned(BookLoan *loanHead, int bookId, int exampleId);
 int getLoanDuration(BookLoan *loanHead, int loanId);
 int getLoanCountForStudent(BookLoan *loanHead, int studentId);
 
-
-void getCurrentDate(char *dateStr) {
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    sprintf(dateStr, "%02d.%02d.%04d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900);
+int32_t daysFromCivil(int year, int month, int day);
+void civilFromDays(int32_t days, int *year, int *month, int *day);
+int parseDate(const char *dateStr, int32_t *days);
+void formatDate(int32_t days, char *dateStr);
+int32_t currentDay();
+int calculateDays(int32_t day1, int32_t day2);
+void indexBookLoan(BookLoan *loan);
+void unindexActiveLoan(BookLoan *loan);
+void printStudentLoanHistory(int studentId);
+void printExampleLoanHistory(int bookId, int exampleId);
+int loanHeapPush(LoanHeap *heap, BookLoan *loan);
+void loanHeapRemove(LoanHeap *heap, BookLoan *loan);
+size_t loanHeapCollect(const LoanHeap *heap, int32_t maxDay, BookLoan ***results);
+void loanHeapFree(LoanHeap *heap);
+int appendArchive(BookLoan **loans, size_t count);
+size_t archiveOldLoans(BookLoan **loanHead, int32_t today);
+size_t readArchivedLoans(int studentId, int bookId, int exampleId, BookLoan **results);
+void penalizedAdd(Student *student);
+void penalizedRemove(Student *student);
+void setStudentPenalty(Student *student, int penaltyDays);
+int chargeLateDays(const BookLoan *loan, int32_t day);
+void runPenaltyTick(int32_t day);
+int penaltyTickDue();
+
+void loadSequences();
+int saveSequences();
+
+uint32_t crc32c(const void *data, size_t size);
+int snapshotIsCurrent();
+int saveSnapshot(Book *bookHead, Author *authorHead, Student *studentHead,
+                 BookLoan *loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount);
+int loadSnapshot(Book **bookHead, Author **authorHead, Student **studentHead,
+                 BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+void snapshotLoadBooks(const SnapshotView *view, Book **bookHead);
+void snapshotLoadAuthors(const SnapshotView *view, Author **authorHead);
+void snapshotLoadStudents(const SnapshotView *view, Student **studentHead);
+void snapshotLoadLoans(const SnapshotView *view, BookLoan **loanHead);
+void snapshotLoadLinks(const SnapshotView *view, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+
+int journalOpen();
+void journalCommit(int force);
+int journalCheckpointDue();
+void journalTruncate();
+void journalClose();
+void journalBookPut(const Book *book);
+void journalAuthorPut(const Author *author);
+void journalStudentPut(const Student *student);
+void journalLoanAdd(const BookLoan *loan);
+void journalLoanReturn(int loanId, int32_t day);
+void journalPenaltyTick(int32_t day);
+void journalLinkAdd(int bookId, int authorId);
+void journalDelete(int type, int id);
+void journalReplay(Book **bookHead, Author **authorHead, Student **studentHead,
+                   BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+void *saveTableThread(void *arg);
+void checkpointTables(Book *bookHead, Author *authorHead, Student *studentHead,
+                      BookLoan **loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount);
+
+void *loadTableThread(void *arg);
+void loadTables(const SnapshotView *snapshot, Book **bookHead, Author **authorHead, Student **studentHead,
+                BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+void linkTables(Book *bookHead, BookAuthor *bookAuthorArray, int bookAuthorCount);
+void closeLibrary(Book *bookHead, Author *authorHead, Student *studentHead,
+                  BookLoan *loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount);
+
+char *batchWord(char **cursor);
+char *batchRest(char **cursor);
+int batchInt(char **cursor, int *value);
+int batchIdRange(const char *word, int *first, int *last);
+int batchText(const char *text, size_t size);
+int batchBadRequest(char *detail, size_t detailSize, const char *reason);
+int runBatchCommand(char *line, char *detail, size_t detailSize, Book **bookHead, Author **authorHead,
+                    Student **studentHead, BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+size_t formatBatchResult(char *result, size_t size, int status, const char *detail);
+int runBatch(const char *fileName, Book **bookHead, Author **authorHead, Student **studentHead,
+             BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+
+int lockDataFiles();
+int serverListen(const char *socketPath);
+void serverAccept(Server *server, int epollFd, int listenFd);
+void serverRead(Connection *conn);
+void serverWrite(Connection *conn);
+int serverDispatch(Server *server, Connection *conn);
+void serverUpdate(Server *server, int epollFd, Connection *conn);
+void serverClose(Server *server, Connection *conn);
+void serverCollect(Server *server, int epollFd);
+void *serverWorker(void *arg);
+int runServer(const char *socketPath, Book **bookHead, Author **authorHead, Student **studentHead,
+              BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount);
+void *stressThread(void *arg);
+int runStress();
+
+void *poolAlloc(NodePool *pool);
+void poolFree(NodePool *pool, void *node);
+void poolDestroy(NodePool *pool);
+
+void *hashIndexGet(const HashIndex *index, uint64_t key);
+int hashIndexInsert(HashIndex *index, uint64_t key, void *value);
+void hashIndexRemove(HashIndex *index, uint64_t key);
+void hashIndexFree(HashIndex *index);
+
+void foldName(const char *name, char *folded, size_t size);
+int nameIndexAppend(NameIndex *index, const char *name, void *node);
+void nameIndexSort(NameIndex *index);
+int nameIndexInsert(NameIndex *index, const char *name, void *node);
+void nameIndexRemove(NameIndex *index, const char *name, void *node);
+size_t nameIndexRemoveIf(NameIndex *index, int (*doomed)(const void *node, void *arg), void *arg);
+size_t nameIndexPrefix(const NameIndex *index, const char *prefix, size_t *first);
+void nameIndexFree(NameIndex *index);
+size_t findBooksByNamePrefix(const char *prefix, Book **results, size_t maxResults);
+size_t findAuthorsByNamePrefix(const char *prefix, Author **results, size_t maxResults);
+size_t findStudentsByNamePrefix(const char *prefix, Student **results, size_t maxResults);
+const char *nextWord(const char *text, char *word, size_t size);
+int wordIndexAdd(HashIndex *index, const char *name, int id);
+void wordIndexRemove(HashIndex *index, const char *name, int id);
+void wordIndexFree(HashIndex *index);
+size_t findBooksByWords(const char *query, Book *bookHead, Author *authorHead,
+                        const BookAuthor *bookAuthorArray, int bookAuthorCount, int *bookIds, size_t maxIds);
+int trigramIndexAdd(TrigramIndex *index, const char *name, int id);
+void trigramIndexRemove(TrigramIndex *index, const char *name, int id);
+void trigramIndexFree(TrigramIndex *index);
+size_t findBooksBySimilarName(const char *query, int *bookIds, size_t maxIds);
+size_t findAuthorsBySimilarName(const char *query, int *authorIds, size_t maxIds);
+size_t findStudentsBySimilarName(const char *query, int *studentIds, size_t maxIds);
+
+int csvOpen(CsvReader *reader, const char *fileName);
+int csvNextRecord(CsvReader *reader, int fieldLimit);
+int csvSplitField(CsvReader *reader, int index);
+void csvReportMalformed(CsvReader *reader, const char *reason);
+void csvClose(CsvReader *reader);
+int csvParseInt(const char *field, size_t length, int *value);
+int csvCopyField(const char *field, size_t length, char *dest, size_t size);
+
+int outReserve(OutBuffer *out, size_t extra);
+int outFlush(OutBuffer *out, FILE *file);
+void outFree(OutBuffer *out);
+char *outInt(char *p, int value);
+char *outDate(char *p, int32_t days);
+char *outText(char *p, const char *text);
+int saveThreadCount();
+
+void markTablesDirty(unsigned tables);
+void lockTables(unsigned readTables, unsigned writeTables);
+void unlockTables(unsigned tables);
+void batchCommandTables(const char *line, unsigned *readTables, unsigned *writeTables);
+FILE *openForRewrite(const char *fileName);
+int finishRewrite(FILE *file, const char *fileName);
+void abandonRewrite(FILE *file, const char *fileName);
+int keepBackup(const char *fileName);
+void syncDirectory();
+
+
+// --- Date Functions ---
+// Dates are kept as day numbers (days since 01.01.1970) and only converted
+// to DD.MM.YYYY text when reading or writing CSV files and printing.
+
+// Day number of a proleptic Gregorian calendar date
+int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
 }
 
-
-int calculateDays(const char *date1Str, const char *date2Str) {
-    struct tm tm1 = {0}, tm2 = {0};
-    sscanf(date1Str, "%d.%d.%d", &tm1.tm_mday, &tm1.tm_mon, &tm1.tm_year);
-    sscanf(date2Str, "%d.%d.%d", &tm2.tm_mday, &tm2.tm_mon, &tm2.tm_year);
-    tm1.tm_mon -= 1; // struct tm months are 0-indexed
-    tm2.tm_mon -= 1;
-    tm1.tm_year -= 1900; // struct tm years are since 1900
-    tm2.tm_year -= 1900;
-
-    time_t t1 = mktime(&tm1);
-    time_t t2 = mktime(&tm2);
-
-    if (t1 == (time_t)-1 || t2 == (time_t)-1) {
-        return -1; // Error in date conversion
-    }
-
-    double seconds = difftime(t2, t1);
-    return (int)(seconds / (60 * 60 * 24));
+// Calendar date of a day number
+void civilFromDays(int32_t days, int *year, int *month, int *day) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    *day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    *month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
 }
 
-
-// Free allocated memory
-void freeBookLoans(BookLoan *head) {
-    BookLoan *temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        free(temp);
+// Parse a DD.MM.YYYY (or DD/MM/YYYY) date. Returns 0 on success, -1 if the
+// text is not a valid date.
+int parseDate(const char *dateStr, int32_t *days) {
+    int parts[3] = {0, 0, 0};
+    int part = 0, digits = 0;
+    for (const char *p = dateStr; ; p++) {
+        if (*p >= '0' && *p <= '9') {
+            parts[part] = parts[part] * 10 + (*p - '0');
+            if (++digits > 4) {
+                return -1;
+            }
+        } else if ((*p == '.' || *p == '/') && part < 2 && digits > 0) {
+            part++;
+            digits = 0;
+        } else if (*p == '\0' || *p == '\n' || *p == '\r') {
+            break;
+        } else {
+            return -1;
+        }
     }
-}
-
-void freeStudents(Student *head) {
-    Student *temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        free(temp);
+    int day = parts[0], month = parts[1], year = parts[2];
+    if (part != 2 || digits == 0 || month < 1 || month > 12 || day < 1) {
+        return -1;
     }
-}
-
-void freeAuthors(Author *head) {
-    Author *temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        free(temp);
+    static const int monthDays[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int isLeap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > monthDays[month - 1] || (month == 2 && day == 29 && !isLeap)) {
+        return -1;
     }
+    *days = daysFromCivil(year, month, day);
+    return 0;
 }
 
-void freeBookExamples(BookExample *head) {
-    BookExample *temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        free(temp);
-    }
+// Format a day number as DD.MM.YYYY
+void formatDate(int32_t days, char *dateStr) {
+    int year, month, day;
+    civilFromDays(days, &year, &month, &day);
+    snprintf(dateStr, MAX_DATE_LEN, "%02u.%02u.%04u", (unsigned)day, (unsigned)month, (unsigned)year % 10000u);
 }
 
-void freeBooks(Book *head) {
-    Book *temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        freeBookExamples(temp->head); // Free book examples for this book
-        free(temp);
-    }
+// Today's local date as a day number. Call once per operation and pass the
+// result down rather than calling it inside loops.
+int32_t currentDay() {
+    time_t t = time(NULL);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return daysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
 }
 
+// Number of days from day1 to day2
+int calculateDays(int32_t day1, int32_t day2) {
+    return day2 - day1;
+}
 
-// --- Book Loan Functions ---
 
-// Load book loans from CSV
-void loadBookLoans(BookLoan **loanHead) {
-    FILE *file = fopen("kitap_odunc.csv", "r");
-    if (!file) {
-        *loanHead = NULL;
-        return;
-    }
+// --- Node Pool Functions ---
 
-    char line[MAX_LINE_LEN];
-    BookLoan *last = NULL;
+#define POOL_FIRST_CHUNK_NODES 64
+#define POOL_MAX_CHUNK_NODES 16384
 
-    // Skip header row
-    fgets(line, sizeof(line), file);
+// Allocate one node, reusing a deleted one when available
+void *poolAlloc(NodePool *pool) {
+    if (pool->freeList) {
+        void *node = pool->freeList;
+        pool->freeList = *(void **)node;
+        return node;
+    }
 
-    while (fgets(line, sizeof(line), file)) {
-        BookLoan *newLoan = (BookLoan *)malloc(sizeof(BookLoan));
-        if (!newLoan) {
-            perror("Memory allocation failed");
-            break; // Exit loop on allocation failure
+    if (pool->chunkUsed == pool->chunkNodes) {
+        if (pool->chunkCount == pool->chunkCapacity) {
+            size_t newCapacity = pool->chunkCapacity ? pool->chunkCapacity * 2 : 16;
+            char **chunks = (char **)realloc(pool->chunks, sizeof(char *) * newCapacity);
+            if (!chunks) {
+                return NULL;
+            }
+            pool->chunks = chunks;
+            pool->chunkCapacity = newCapacity;
         }
-        newLoan->next = NULL;
-
-        // Parse CSV line: loanId,bookId,exampleId,studentId,loanDate,returnDate,returned
-        sscanf(line, "%d,%d,%d,%d,%[^,],%[^,],%d",
-               &newLoan->loanId, &newLoan->bookId, &newLoan->exampleId, &newLoan->studentId,
-               newLoan->loanDate, newLoan->returnDate, &newLoan->returned);
 
-        if (*loanHead == NULL) {
-            *loanHead = newLoan;
-            last = newLoan;
-        } else {
-            last->next = newLoan;
-            last = newLoan;
+        size_t nodes = pool->nextChunkNodes ? pool->nextChunkNodes : POOL_FIRST_CHUNK_NODES;
+        char *chunk = (char *)malloc(pool->nodeSize * nodes);
+        if (!chunk) {
+            return NULL;
         }
+        pool->chunks[pool->chunkCount++] = chunk;
+        pool->chunkNodes = nodes;
+        pool->chunkUsed = 0;
+        pool->nextChunkNodes = nodes * 2 < POOL_MAX_CHUNK_NODES ? nodes * 2 : POOL_MAX_CHUNK_NODES;
     }
-    fclose(file);
+
+    return pool->chunks[pool->chunkCount - 1] + pool->nodeSize * pool->chunkUsed++;
 }
 
-// Save book loans to CSV
-void saveBookLoans(BookLoan *loanHead) {
-    FILE *file = fopen("kitap_odunc.csv", "w");
-    if (!file) {
-        perror("Error opening kitap_odunc.csv for writing");
+// Return a node to its pool's free list
+void poolFree(NodePool *pool, void *node) {
+    if (!node) {
         return;
     }
+    *(void **)node = pool->freeList;
+    pool->freeList = node;
+}
 
-    // Write header
-    fprintf(file, "loanId,bookId,exampleId,studentId,loanDate,returnDate,returned\n");
-
-    BookLoan *current = loanHead;
-    while (current != NULL) {
-        fprintf(file, "%d,%d,%d,%d,%s,%s,%d\n",
-                current->loanId, current->bookId, current->exampleId, current->studentId,
-                current->loanDate, current->returnDate, current->returned);
-        current = current->next;
+// Release every node of the pool at once
+void poolDestroy(NodePool *pool) {
+    for (size_t i = 0; i < pool->chunkCount; i++) {
+        free(pool->chunks[i]);
     }
-    fclose(file);
+    free(pool->chunks);
+    size_t nodeSize = pool->nodeSize;
+    memset(pool, 0, sizeof(*pool));
+    pool->nodeSize = nodeSize;
 }
 
-// Add a new book loan
-void addBookLoan(BookLoan **loanHead, Book *bookHead) {
-    int studentId, bookId, exampleId;
-    char loanDate[MAX_DATE_LEN];
-    char returnDate[MAX_DATE_LEN];
-
-    printf("Enter Student ID: ");
-    scanf("%d", &studentId);
-    getchar(); 
 
-    printf("Enter Book ID: ");
-    scanf("%d", &bookId);
-    getchar(); 
+// --- Hash Index Functions ---
 
-    printf("Enter Example ID: ");
-    scanf("%d", &exampleId);
-    getchar(); 
+// Mix the key bits so that sequential IDs spread over the whole table
+static uint64_t hashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
 
-    // Check if the book example is available
-    Book *book = findBookById(bookHead, bookId);
-    if (!book) {
-        printf("Book not found.\n");
-        return;
-    }
-    BookExample *example = book->head;
-    while (example != NULL && example->exampleId != exampleId) {
-        example = example->next;
+// Find the value stored for a key, or NULL if the key is not indexed
+void *hashIndexGet(const HashIndex *index, uint64_t key) {
+    if (index->capacity == 0) {
+        return NULL;
     }
-    if (!example || example->status == 1) {
-        printf("Book example not available for loan.\n");
-        return;
+    size_t mask = index->capacity - 1;
+    size_t i = hashKey(key) & mask;
+    while (index->values[i] != NULL) {
+        if (index->keys[i] == key) {
+            return index->values[i];
+        }
+        i = (i + 1) & mask;
     }
+    return NULL;
+}
 
-    getCurrentDate(loanDate);
-    // Calculate return date 
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    tm.tm_mday += 14; // Add 14 days
-    mktime(&tm); // Normalize the date
-    sprintf(returnDate, "%02d.%02d.%04d", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900);
-
-
-    BookLoan *newLoan = (BookLoan *)malloc(sizeof(BookLoan));
-    if (!newLoan) {
+// Rehash every entry into a table of the given capacity
+static int hashIndexResize(HashIndex *index, size_t newCapacity) {
+    uint64_t *newKeys = (uint64_t *)malloc(sizeof(uint64_t) * newCapacity);
+    void **newValues = (void **)calloc(newCapacity, sizeof(void *));
+    if (!newKeys || !newValues) {
         perror("Memory allocation failed");
-        return;
+        free(newKeys);
+        free(newValues);
+        return -1;
     }
-    newLoan->next = NULL;
 
-    // Find the next available loan ID
-    int maxLoanId = 0;
-    BookLoan *current = *loanHead;
-    while (current != NULL) {
-        if (current->loanId > maxLoanId) {
-            maxLoanId = current->loanId;
+    size_t mask = newCapacity - 1;
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->values[i] != NULL) {
+            size_t j = hashKey(index->keys[i]) & mask;
+            while (newValues[j] != NULL) {
+                j = (j + 1) & mask;
+            }
+            newKeys[j] = index->keys[i];
+            newValues[j] = index->values[i];
         }
-        current = current->next;
     }
-    newLoan->loanId = maxLoanId + 1;
 
-    newLoan->bookId = bookId;
-    newLoan->exampleId = exampleId;
-    newLoan->studentId = studentId;
-    strcpy(newLoan->loanDate, loanDate);
-    strcpy(newLoan->returnDate, returnDate);
-    newLoan->returned = 0; // Not returned yet
+    free(index->keys);
+    free(index->values);
+    index->keys = newKeys;
+    index->values = newValues;
+    index->capacity = newCapacity;
+    return 0;
+}
 
-    // Add to the end of the list
-    if (*loanHead == NULL) {
-        *loanHead = newLoan;
-    } else {
-        current = *loanHead;
-        while (current->next != NULL) {
-            current = current->next;
+// Insert a key. Returns 0 on success, 1 if the key already exists (the
+// existing entry is kept) and -1 on allocation failure.
+int hashIndexInsert(HashIndex *index, uint64_t key, void *value) {
+    // Keep the load factor at or below 3/4
+    if ((index->count + 1) * 4 > index->capacity * 3) {
+        size_t newCapacity = index->capacity ? index->capacity * 2 : 16;
+        if (hashIndexResize(index, newCapacity) != 0) {
+            return -1;
         }
-        current->next = newLoan;
     }
 
-    // Update book example status
-    updateBookExampleStatus(bookHead, bookId, exampleId, 1); // Set status to borrowed
-
-    printf("Book loaned successfully.\n");
-}
-
-// Return a book
-void returnBook(BookLoan **loanHead, Book *bookHead) {
-    int loanId;
-    printf("Enter Loan ID to return: ");
-    scanf("%d", &loanId);
-    getchar(); 
-
-    BookLoan *current = *loanHead;
-    BookLoan *prev = NULL;
-    while (current != NULL && current->loanId != loanId) {
-        prev = current;
-        current = current->next;
+    size_t mask = index->capacity - 1;
+    size_t i = hashKey(key) & mask;
+    while (index->values[i] != NULL) {
+        if (index->keys[i] == key) {
+            return 1;
+        }
+        i = (i + 1) & mask;
     }
+    index->keys[i] = key;
+    index->values[i] = value;
+    index->count++;
+    return 0;
+}
 
-    if (!current) {
-        printf("Loan with ID %d not found.\n", loanId);
+// Remove a key, shifting later entries of the probe run back so that no
+// tombstones are needed
+void hashIndexRemove(HashIndex *index, uint64_t key) {
+    if (index->capacity == 0) {
         return;
     }
-
-    if (current->returned == 1) {
-        printf("Book for Loan ID %d has already been returned.\n", loanId);
-        return;
+    size_t mask = index->capacity - 1;
+    size_t i = hashKey(key) & mask;
+    while (index->values[i] != NULL && index->keys[i] != key) {
+        i = (i + 1) & mask;
+    }
+    if (index->values[i] == NULL) {
+        return; // Not found
     }
 
-    // Update loan status
-    current->returned = 1;
+    index->values[i] = NULL;
+    index->count--;
 
-    // Update book example status
-    updateBookExampleStatus(bookHead, current->bookId, current->exampleId, 0); // Set status to on Shelf
+    size_t j = i;
+    while (1) {
+        j = (j + 1) & mask;
+        if (index->values[j] == NULL) {
+            break;
+        }
+        size_t home = hashKey(index->keys[j]) & mask;
+        // Move the entry back unless its home slot lies cyclically in (i, j]
+        int stays = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            index->keys[i] = index->keys[j];
+            index->values[i] = index->values[j];
+            index->values[j] = NULL;
+            i = j;
+        }
+    }
+}
 
-    printf("Book returned successfully.\n");
+// Release the memory held by an index
+void hashIndexFree(HashIndex *index) {
+    free(index->keys);
+    free(index->values);
+    index->keys = NULL;
+    index->values = NULL;
+    index->capacity = 0;
+    index->count = 0;
 }
 
 
-// Print all book loans
-void printBookLoans(BookLoan *loanHead) {
-    if (!loanHead) {
-        printf("No book loans recorded.\n");
-        return;
+// --- Name Index Functions ---
+
+#define MAX_FOLDED_LEN (2 * MAX_NAME_LEN) // Folding 'I' to dotless 'ı' grows a byte
+
+// Fold a UTF-8 name to lower case using the Turkish rules: 'I' becomes
+// dotless 'ı' and dotted 'İ' becomes 'i'. Other ASCII and Latin-1 capitals
+// plus Ğ and Ş map to their lower-case forms; all other bytes are copied.
+void foldName(const char *name, char *folded, size_t size) {
+    const unsigned char *p = (const unsigned char *)name;
+    size_t n = 0;
+    while (*p && n + 2 < size) {
+        if (*p == 'I') {
+            folded[n++] = (char)0xC4; // ı
+            folded[n++] = (char)0xB1;
+            p++;
+        } else if (*p >= 'A' && *p <= 'Z') {
+            folded[n++] = (char)(*p + ('a' - 'A'));
+            p++;
+        } else if (p[0] == 0xC4 && p[1] == 0xB0) {
+            folded[n++] = 'i'; // İ
+            p += 2;
+        } else if (p[0] == 0xC3 && p[1] >= 0x80 && p[1] <= 0x9E && p[1] != 0x97) {
+            folded[n++] = (char)0xC3; // Latin-1 capitals such as Ç, Ö, Ü
+            folded[n++] = (char)(p[1] + 0x20);
+            p += 2;
+        } else if ((p[0] == 0xC4 && p[1] == 0x9E) || (p[0] == 0xC5 && p[1] == 0x9E)) {
+            folded[n++] = (char)p[0]; // Ğ, Ş
+            folded[n++] = (char)(p[1] + 1);
+            p += 2;
+        } else {
+            folded[n++] = (char)*p++;
+        }
     }
-    printf("\n--- Book Loans ---\n");
-    printf("ID | Book ID | Example ID | Student ID | Loan Date | Return Date | Returned\n");
-    printf("---|---------|------------|------------|-----------|-------------|---------\n");
-    BookLoan *tmp = loanHead;
-    while (tmp != NULL) {
-        printf("%-2d | %-7d | %-10d | %-10d | %-9s | %-11s | %d\n",
-               tmp->loanId, tmp->bookId, tmp->exampleId, tmp->studentId,
-               tmp->loanDate, tmp->returnDate, tmp->returned);
-        tmp = tmp->next;
+    folded[n] = '\0';
+}
+
+// Make room for one more entry
+static int nameIndexReserve(NameIndex *index) {
+    if (index->count < index->capacity) {
+        return 0;
     }
-    printf("-------------------\n");
+    size_t newCapacity = index->capacity ? index->capacity * 2 : 16;
+    NameEntry *entries = (NameEntry *)realloc(index->entries, sizeof(NameEntry) * newCapacity);
+    if (!entries) {
+        perror("Memory re-allocation failed");
+        return -1;
+    }
+    index->entries = entries;
+    index->capacity = newCapacity;
+    return 0;
 }
 
-// Print overdue book loans
-void printOverdueLoans(BookLoan *loanHead) {
-    char currentDate[MAX_DATE_LEN];
-    getCurrentDate(currentDate);
+// First position whose key is >= key (or > key when upper is set)
+static size_t nameIndexBound(const NameIndex *index, const char *key, int upper) {
+    size_t low = 0, high = index->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int cmp = strcmp(index->entries[mid].key, key);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
 
-    printf("\n--- Overdue Book Loans ---\n");
-    printf("ID | Book ID | Example ID | Student ID | Loan Date | Return Date\n");
-    printf("---|---------|------------|------------|-----------|-------------\n");
+// Append an entry without keeping the order; call nameIndexSort after a
+// bulk load
+int nameIndexAppend(NameIndex *index, const char *name, void *node) {
+    char folded[MAX_FOLDED_LEN];
+    foldName(name, folded, sizeof(folded));
+    if (nameIndexReserve(index) != 0) {
+        return -1;
+    }
+    char *key = strdup(folded);
+    if (!key) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+    index->entries[index->count].key = key;
+    index->entries[index->count].node = node;
+    index->count++;
+    return 0;
+}
 
-    BookLoan *tmp = loanHead;
-    int foundOverdue = 0;
-    while (tmp != NULL) {
-        if (tmp->returned == 0) {
-            int days = calculateDays(tmp->returnDate, currentDate);
-            if (days > 0) {
-                printf("%-2d | %-7d | %-10d | %-10d | %-9s | %-11s\n",
-                       tmp->loanId, tmp->bookId, tmp->exampleId, tmp->studentId,
-                       tmp->loanDate, tmp->returnDate);
-                foundOverdue = 1;
+// Stable merge sort of the entries by key
+void nameIndexSort(NameIndex *index) {
+    size_t n = index->count;
+    if (n < 2) {
+        return;
+    }
+    NameEntry *buffer = (NameEntry *)malloc(sizeof(NameEntry) * n);
+    if (!buffer) {
+        perror("Memory allocation failed");
+        return;
+    }
+    NameEntry *src = index->entries, *dst = buffer;
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t left = 0; left < n; left += 2 * width) {
+            size_t mid = left + width < n ? left + width : n;
+            size_t right = left + 2 * width < n ? left + 2 * width : n;
+            size_t i = left, j = mid, k = left;
+            while (i < mid && j < right) {
+                dst[k++] = (strcmp(src[j].key, src[i].key) < 0) ? src[j++] : src[i++];
+            }
+            while (i < mid) {
+                dst[k++] = src[i++];
+            }
+            while (j < right) {
+                dst[k++] = src[j++];
             }
         }
-        tmp = tmp->next;
+        NameEntry *tmp = src;
+        src = dst;
+        dst = tmp;
     }
-
-    if (!foundOverdue) {
-        printf("No overdue book loans.\n");
+    if (src != index->entries) {
+        memcpy(index->entries, src, sizeof(NameEntry) * n);
     }
-    printf("--------------------------\n");
+    free(buffer);
 }
 
+// Insert an entry at its sorted position, after any equal keys
+int nameIndexInsert(NameIndex *index, const char *name, void *node) {
+    if (nameIndexAppend(index, name, node) != 0) {
+        return -1;
+    }
+    NameEntry entry = index->entries[index->count - 1];
+    index->count--;
+    size_t pos = nameIndexBound(index, entry.key, 1);
+    memmove(&index->entries[pos + 1], &index->entries[pos], sizeof(NameEntry) * (index->count - pos));
+    index->entries[pos] = entry;
+    index->count++;
+    return 0;
+}
 
-// Check if a specific book example is returned
-int isBookReturned(BookLoan *loanHead, int bookId, int exampleId) {
-    BookLoan *temp = loanHead;
-    while (temp != NULL) {
-        if (temp->bookId == bookId && temp->exampleId == exampleId && temp->returned == 0) {
-            return 0; // Found an active loan for this example
+// Remove the entry for a node indexed under the given name
+void nameIndexRemove(NameIndex *index, const char *name, void *node) {
+    char folded[MAX_FOLDED_LEN];
+    foldName(name, folded, sizeof(folded));
+    for (size_t i = nameIndexBound(index, folded, 0);
+         i < index->count && strcmp(index->entries[i].key, folded) == 0; i++) {
+        if (index->entries[i].node == node) {
+            free(index->entries[i].key);
+            memmove(&index->entries[i], &index->entries[i + 1], sizeof(NameEntry) * (index->count - i - 1));
+            index->count--;
+            return;
         }
-        temp = temp->next;
     }
-    return 1; // No active loan found, assumed returned or never borrowed
 }
 
-// Get the duration of a loan in days
-int getLoanDuration(BookLoan *loanHead, int loanId) {
-    BookLoan *temp = loanHead;
-    while (temp != NULL) {
-        if (temp->loanId == loanId) {
-            char returnDate[MAX_DATE_LEN];
-            getCurrentDate(returnDate); // Use current date for calculation
-            return calculateDays(temp->loanDate, returnDate);
+// Remove every entry whose node the doomed callback accepts, in one pass
+// that keeps the order. Returns the number of entries removed.
+size_t nameIndexRemoveIf(NameIndex *index, int (*doomed)(const void *node, void *arg), void *arg) {
+    size_t kept = 0;
+    for (size_t i = 0; i < index->count; i++) {
+        if (doomed(index->entries[i].node, arg)) {
+            free(index->entries[i].key);
+        } else {
+            index->entries[kept++] = index->entries[i];
         }
-        temp = temp->next;
     }
-    return -1; // Loan not found
+    size_t removed = index->count - kept;
+    index->count = kept;
+    return removed;
 }
 
-// Get the number of active loans for a student
-int getLoanCountForStudent(BookLoan *loanHead, int studentId) {
-    int count = 0;
-    BookLoan *temp = loanHead;
-    while (temp != NULL) {
-        if (temp->studentId == studentId && temp->returned == 0) {
-            count++;
-        }
-        temp = temp->next;
+// Find the entries whose folded key starts with the folded prefix. Returns
+// the number of matches, which are entries[*first .. *first + count).
+size_t nameIndexPrefix(const NameIndex *index, const char *prefix, size_t *first) {
+    char folded[MAX_FOLDED_LEN];
+    foldName(prefix, folded, sizeof(folded));
+    size_t len = strlen(folded);
+    size_t start = nameIndexBound(index, folded, 0);
+    size_t end = start;
+    while (end < index->count && strncmp(index->entries[end].key, folded, len) == 0) {
+        end++;
     }
-    return count;
+    *first = start;
+    return end - start;
 }
 
+// Release the memory held by a name index
+void nameIndexFree(NameIndex *index) {
+    for (size_t i = 0; i < index->count; i++) {
+        free(index->entries[i].key);
+    }
+    free(index->entries);
+    index->entries = NULL;
+    index->count = 0;
+    index->capacity = 0;
+}
 
-// --- Book Functions ---
+// Find the node whose name matches exactly (case-sensitive)
+static void *nameIndexFindExact(const NameIndex *index, const char *name, size_t nameOffset) {
+    char folded[MAX_FOLDED_LEN];
+    foldName(name, folded, sizeof(folded));
+    for (size_t i = nameIndexBound(index, folded, 0);
+         i < index->count && strcmp(index->entries[i].key, folded) == 0; i++) {
+        const char *nodeName = (const char *)index->entries[i].node + nameOffset;
+        if (strcmp(nodeName, name) == 0) {
+            return index->entries[i].node;
+        }
+    }
+    return NULL;
+}
 
-// Load books from CSV
-void loadBooks(Book **bookHead) {
-    FILE *file = fopen("kitaplar.csv", "r");
-    if (!file) {
-        *bookHead = NULL;
-        return;
+// Copy up to maxResults nodes whose name starts with the prefix, ignoring
+// case. Returns the total number of matches.
+static size_t nameIndexCollect(const NameIndex *index, const char *prefix, void **results, size_t maxResults) {
+    size_t first;
+    size_t total = nameIndexPrefix(index, prefix, &first);
+    for (size_t i = 0; i < total && i < maxResults; i++) {
+        results[i] = index->entries[first + i].node;
     }
+    return total;
+}
 
-    char line[MAX_LINE_LEN];
-    Book *last = NULL;
+size_t findBooksByNamePrefix(const char *prefix, Book **results, size_t maxResults) {
+    return nameIndexCollect(&bookNameIndex, prefix, (void **)results, maxResults);
+}
 
-    // Skip header row
-    fgets(line, sizeof(line), file);
+size_t findAuthorsByNamePrefix(const char *prefix, Author **results, size_t maxResults) {
+    return nameIndexCollect(&authorNameIndex, prefix, (void **)results, maxResults);
+}
 
-    while (fgets(line, sizeof(line), file)) {
-        Book *newBook = (Book *)malloc(sizeof(Book));
-        if (!newBook) {
-            perror("Memory allocation failed");
-            break; 
-        }
-        newBook->next = NULL;
-        newBook->head = NULL; // Initialize book examples head
+size_t findStudentsByNamePrefix(const char *prefix, Student **results, size_t maxResults) {
+    return nameIndexCollect(&studentNameIndex, prefix, (void **)results, maxResults);
+}
 
-        // Parse CSV line: bookId,bookName,ISBN,exampleCount
-        int exampleCount;
-        sscanf(line, "%d,%[^,],%[^,],%d",
-               &newBook->bookId, newBook->bookName, newBook->ISBN, &exampleCount);
-
-        // Create book examples
-        BookExample *lastExample = NULL;
-        for (int i = 0; i < exampleCount; i++) {
-            BookExample *newExample = (BookExample *)malloc(sizeof(BookExample));
-            if (!newExample) {
-                perror("Memory allocation failed");
-                break; 
-            }
-            newExample->exampleId = i + 1;
-            newExample->status = 0; // Default status: On Shelf
-            newExample->next = NULL;
 
-            if (newBook->head == NULL) {
-                newBook->head = newExample;
-                lastExample = newExample;
-            } else {
-                lastExample->next = newExample;
-                lastExample = newExample;
+// --- Word Index Functions ---
+// Inverted indexes from the words of book titles and author names to the
+// IDs whose name contains them. A word is a run of letters and digits,
+// folded to lower case without diacritics, so "Işık", "ISIK" and "isik" are
+// the same word. Each posting list keeps its IDs ascending as varint gaps.
+
+#define MAX_WORD_LEN 64 // Longer words are cut
+#define MAX_QUERY_WORDS 8 // Words of a search past this are ignored
+
+// Base letters of U+00C0 .. U+00FF; ' ' marks the signs that split words
+static const char latinBaseLetters[] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                       "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+// Read the next word of a UTF-8 text into word, folded to lower case
+// without diacritics: Turkish 'I', 'İ' and 'ı' all become 'i', 'ğ' becomes
+// 'g' and so on. Other non-ASCII characters are kept as they are. Returns
+// the text after the word, or NULL if no word is left.
+const char *nextWord(const char *text, char *word, size_t size) {
+    const unsigned char *p = (const unsigned char *)text;
+    size_t n = 0;
+    while (*p) {
+        char letter = 0;
+        size_t length = 1;
+        if (*p < 0x80) {
+            if ((*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9')) {
+                letter = (char)*p;
+            } else if (*p >= 'A' && *p <= 'Z') {
+                letter = (char)(*p - 'A' + 'a');
+            }
+        } else if (p[0] == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+            letter = latinBaseLetters[p[1] - 0x80] == ' ' ? 0 : latinBaseLetters[p[1] - 0x80];
+            length = 2;
+        } else if (p[0] == 0xC4 && (p[1] == 0x9E || p[1] == 0x9F)) {
+            letter = 'g'; // Ğ, ğ
+            length = 2;
+        } else if (p[0] == 0xC4 && (p[1] == 0xB0 || p[1] == 0xB1)) {
+            letter = 'i'; // İ, ı
+            length = 2;
+        } else if (p[0] == 0xC5 && (p[1] == 0x9E || p[1] == 0x9F)) {
+            letter = 's'; // Ş, ş
+            length = 2;
+        } else {
+            while (length < 4 && (p[length] & 0xC0) == 0x80) {
+                length++;
+            }
+            if (n + length < size) {
+                memcpy(word + n, p, length);
+                n += length;
             }
+            p += length;
+            continue;
         }
 
-        if (*bookHead == NULL) {
-            *bookHead = newBook;
-            last = newBook;
-        } else {
-            last->next = newBook;
-            last = newBook;
+        if (letter == 0) {
+            p += length;
+            if (n > 0) {
+                break;
+            }
+            continue;
+        }
+        if (n + 1 < size) {
+            word[n++] = letter;
         }
+        p += length;
     }
-    fclose(file);
+    if (n == 0) {
+        return NULL;
+    }
+    word[n] = '\0';
+    return (const char *)p;
 }
 
-// Save books to CSV
-void saveBooks(Book *bookHead) {
-    FILE *file = fopen("kitaplar.csv", "w");
-    if (!file) {
-        perror("Error opening kitaplar.csv for writing");
-        return;
+// FNV-1a hash of a folded word
+static uint64_t wordKey(const char *word) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char *p = (const unsigned char *)word; *p; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
     }
+    return hash;
+}
 
-    // Write header
-    fprintf(file, "bookId,bookName,ISBN,exampleCount\n");
-
-    Book *currentBook = bookHead;
-    while (currentBook != NULL) {
-        // Count book examples
-        int exampleCount = 0;
-        BookExample *currentExample = currentBook->head;
-        while (currentExample != NULL) {
-            exampleCount++;
-            currentExample = currentExample->next;
+// Find the posting list of a folded word, creating an empty one if create
+// is set. Words whose hashes collide take the following keys, so posting
+// lists stay in the index once created, even when they become empty.
+static Posting *wordIndexFind(HashIndex *index, const char *word, int create) {
+    uint64_t key = wordKey(word);
+    Posting *posting;
+    while ((posting = (Posting *)hashIndexGet(index, key)) != NULL) {
+        if (strcmp(posting->word, word) == 0) {
+            return posting;
         }
-        fprintf(file, "%d,%s,%s,%d\n",
-                currentBook->bookId, currentBook->bookName, currentBook->ISBN, exampleCount);
-        currentBook = currentBook->next;
+        key++;
     }
-    fclose(file);
+    if (!create) {
+        return NULL;
+    }
+    size_t length = strlen(word);
+    posting = (Posting *)calloc(1, sizeof(Posting) + length + 1);
+    if (!posting) {
+        perror("Memory allocation failed");
+        return NULL;
+    }
+    memcpy(posting->word, word, length + 1);
+    if (hashIndexInsert(index, key, posting) != 0) {
+        free(posting);
+        return NULL;
+    }
+    return posting;
 }
 
+// Encoded bytes of a posting list. Lists start inline in the node and move
+// to the heap once they outgrow it.
+static unsigned char *postingBytes(Posting *posting) {
+    return posting->capacity == 0 ? posting->data.inlineBytes : posting->data.bytes;
+}
 
-// Add a new book
-void addBook(Book **bookHead) {
-    Book *newBook = (Book *)malloc(sizeof(Book));
-    if (!newBook) {
-        perror("Memory allocation failed");
-        return;
+// Append an ID to a posting list as the varint of its gap to the previous
+// ID: seven bits per byte, low bits first, the high bit set on all bytes
+// but the last
+static int postingAppend(Posting *posting, int id) {
+    uint32_t capacity = posting->capacity ? posting->capacity : POSTING_INLINE_BYTES;
+    if (posting->size + 5 > capacity) {
+        uint32_t newCapacity = capacity * 2;
+        unsigned char *data;
+        if (posting->capacity == 0) {
+            data = (unsigned char *)malloc(newCapacity);
+            if (data) {
+                memcpy(data, posting->data.inlineBytes, posting->size);
+            }
+        } else {
+            data = (unsigned char *)realloc(posting->data.bytes, newCapacity);
+        }
+        if (!data) {
+            perror("Memory re-allocation failed");
+            return -1;
+        }
+        posting->data.bytes = data;
+        posting->capacity = newCapacity;
     }
-    newBook->next = NULL;
-    newBook->head = NULL; // Initialize book examples head
+    unsigned char *bytes = postingBytes(posting);
+    uint32_t gap = (uint32_t)id - (uint32_t)posting->lastId;
+    while (gap >= 0x80) {
+        bytes[posting->size++] = (unsigned char)(gap | 0x80);
+        gap >>= 7;
+    }
+    bytes[posting->size++] = (unsigned char)gap;
+    posting->lastId = id;
+    posting->count++;
+    return 0;
+}
 
-    // Find the next available book ID
-    int maxBookId = 0;
-    Book *current = *bookHead;
-    while (current != NULL) {
-        if (current->bookId > maxBookId) {
-            maxBookId = current->bookId;
+// Decode a posting list into ids, which must hold posting->count entries
+static void postingDecode(Posting *posting, int *ids) {
+    const unsigned char *p = postingBytes(posting);
+    uint32_t id = 0;
+    for (int i = 0; i < posting->count; i++) {
+        uint32_t gap = 0;
+        int shift = 0;
+        while (*p & 0x80) {
+            gap |= (uint32_t)(*p++ & 0x7F) << shift;
+            shift += 7;
         }
-        current = current->next;
+        gap |= (uint32_t)*p++ << shift;
+        id += gap;
+        ids[i] = (int)id;
     }
-    newBook->bookId = maxBookId + 1;
-
-    printf("Enter Book Name: ");
-    fgets(newBook->bookName, sizeof(newBook->bookName), stdin);
-    newBook->bookName[strcspn(newBook->bookName, "\n")] = 0; 
+}
 
-    printf("Enter ISBN: ");
-    fgets(newBook->ISBN, sizeof(newBook->ISBN), stdin);
-    newBook->ISBN[strcspn(newBook->ISBN, "\n")] = 0; 
-
-    int exampleCount;
-    printf("Enter Number of Examples: ");
-    scanf("%d", &exampleCount);
-    getchar(); 
-
-    // Create book examples
-    BookExample *lastExample = NULL;
-    for (int i = 0; i < exampleCount; i++) {
-        BookExample *newExample = (BookExample *)malloc(sizeof(BookExample));
-        if (!newExample) {
-            perror("Memory allocation failed");
-            break; 
-        }
-        newExample->exampleId = i + 1;
-        newExample->status = 0; // Default status on shelf
-        newExample->next = NULL;
-
-        if (newBook->head == NULL) {
-            newBook->head = newExample;
-            lastExample = newExample;
-        }
-        else {
-            lastExample->next = newExample;
-            lastExample = newExample;
+// Re-encode a posting list from count ascending IDs
+static int postingEncode(Posting *posting, const int *ids, int count) {
+    posting->size = 0;
+    posting->count = 0;
+    posting->lastId = 0;
+    for (int i = 0; i < count; i++) {
+        if (postingAppend(posting, ids[i]) != 0) {
+            return -1;
         }
     }
+    return 0;
+}
 
+// Decode a posting list into a new array. Returns NULL for an empty list
+// or on allocation failure.
+static int *postingIds(Posting *posting) {
+    if (!posting || posting->count == 0) {
+        return NULL;
+    }
+    int *ids = (int *)malloc(sizeof(int) * posting->count);
+    if (!ids) {
+        perror("Memory allocation failed");
+        return NULL;
+    }
+    postingDecode(posting, ids);
+    return ids;
+}
 
-    // Add to the end of the list
-    if (*bookHead == NULL) {
-        *bookHead = newBook;
-    } else {
-        current = *bookHead;
-        while (current->next != NULL) {
-            current = current->next;
+// First position at or after start whose ID is >= id: the step doubles
+// until it passes id, then a binary search covers the last step
+static size_t gallopTo(const int *ids, size_t count, size_t start, int id) {
+    size_t low = start, high = start, step = 1;
+    while (high < count && ids[high] < id) {
+        low = high + 1;
+        high += step;
+        step *= 2;
+    }
+    if (high > count) {
+        high = count;
+    }
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (ids[mid] < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
-        current->next = newBook;
     }
-
-    printf("Book added successfully with ID %d.\n", newBook->bookId);
+    return low;
 }
 
-// Delete a book
-void deleteBook(Book **bookHead, BookLoan *loanHead) {
-    int bookId;
-    printf("Enter Book ID to delete: ");
-    scanf("%d", &bookId);
-    getchar(); 
+// Add an ID to a posting list. An ID above the largest one is appended;
+// a smaller one (hand-edited files, explicit IDs) re-encodes the list.
+static int postingAdd(Posting *posting, int id) {
+    if (posting->count == 0 || id > posting->lastId) {
+        return postingAppend(posting, id);
+    }
+    if (id == posting->lastId) {
+        return 0;
+    }
+    int *ids = (int *)malloc(sizeof(int) * (posting->count + 1));
+    if (!ids) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+    postingDecode(posting, ids);
+    size_t count = (size_t)posting->count;
+    size_t pos = gallopTo(ids, count, 0, id);
+    int result = 0;
+    if (ids[pos] != id) {
+        memmove(&ids[pos + 1], &ids[pos], sizeof(int) * (count - pos));
+        ids[pos] = id;
+        result = postingEncode(posting, ids, (int)count + 1);
+    }
+    free(ids);
+    return result;
+}
 
-    Book *current = *bookHead;
-    Book *prev = NULL;
-    while (current != NULL && current->bookId != bookId) {
-        prev = current;
-        current = current->next;
+// Index every word of a name under an ID
+static int wordIndexPut(HashIndex *index, const char *name, int id) {
+    char word[MAX_WORD_LEN];
+    const char *rest = name;
+    while ((rest = nextWord(rest, word, sizeof(word))) != NULL) {
+        Posting *posting = wordIndexFind(index, word, 1);
+        if (!posting || postingAdd(posting, id) != 0) {
+            return -1;
+        }
     }
+    return 0;
+}
 
-    if (!current) {
-        printf("Book with ID %d not found.\n", bookId);
+// Remove the given IDs (ascending) from a posting list
+static void postingRemoveIds(Posting *posting, const int *doomed, size_t doomedCount) {
+    int *ids = postingIds(posting);
+    if (!ids) {
         return;
     }
-
-    // Check if any examples of this book are currently borrowed
-    BookExample *example = current->head;
-    while (example != NULL) {
-        if (example->status == 1) {
-            printf("Cannot delete book. Some examples are currently borrowed.\n");
-            return;
+    size_t kept = 0, pos = 0;
+    for (int i = 0; i < posting->count; i++) {
+        pos = gallopTo(doomed, doomedCount, pos, ids[i]);
+        if (pos == doomedCount || doomed[pos] != ids[i]) {
+            ids[kept++] = ids[i];
         }
-        example = example->next;
     }
-
-
-    if (prev == NULL) {
-        *bookHead = current->next; // Deleting the head
-    } else {
-        prev->next = current->next;
+    if (kept < (size_t)posting->count) {
+        postingEncode(posting, ids, (int)kept);
     }
-
-    freeBookExamples(current->head); // Free book examples
-    free(current); // Free the book node
-
-
-    printf("Book with ID %d deleted successfully.\n", bookId);
+    free(ids);
 }
 
-// Update book information
-void updateBook(Book *bookHead) {
-    int bookId;
-    printf("Enter Book ID to update: ");
-    scanf("%d", &bookId);
-    getchar(); 
+// Index a new or renamed name, once the word indexes are built
+int wordIndexAdd(HashIndex *index, const char *name, int id) {
+    if (!__atomic_load_n(&wordIndexesBuilt, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    return wordIndexPut(index, name, id);
+}
 
-    Book *book = findBookById(bookHead, bookId);
-    if (!book) {
-        printf("Book with ID %d not found.\n", bookId);
+// Remove an ID from the posting lists of a name's words
+void wordIndexRemove(HashIndex *index, const char *name, int id) {
+    if (!__atomic_load_n(&wordIndexesBuilt, __ATOMIC_ACQUIRE)) {
         return;
     }
-
-    printf("Enter new Book Name (leave blank to keep current '%s'): ", book->bookName);
-    char newBookName[MAX_NAME_LEN];
-    fgets(newBookName, sizeof(newBookName), stdin);
-    newBookName[strcspn(newBookName, "\n")] = 0; 
-    if (strlen(newBookName) > 0) {
-        strcpy(book->bookName, newBookName);
+    char word[MAX_WORD_LEN];
+    const char *rest = name;
+    while ((rest = nextWord(rest, word, sizeof(word))) != NULL) {
+        Posting *posting = wordIndexFind(index, word, 0);
+        if (posting) {
+            postingRemoveIds(posting, &id, 1);
+        }
     }
+}
 
-    printf("Enter new ISBN (leave blank to keep current '%s'): ", book->ISBN);
-    char newISBN[MAX_ISBN_LEN];
-    fgets(newISBN, sizeof(newISBN), stdin);
-    newISBN[strcspn(newISBN, "\n")] = 0; 
-    if (strlen(newISBN) > 0) {
-        strcpy(book->ISBN, newISBN);
-    }
+// Ascending order of ints, for qsort
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
 
-    printf("Book with ID %d updated successfully.\n", bookId);
+// Start a bulk removal of the IDs of a delete batch table. Returns -1 if
+// there is nothing to remove or no memory.
+static int postingBatchStart(PostingBatch *batch, const HashIndex *nodes) {
+    memset(batch, 0, sizeof(*batch));
+    if (nodes->count == 0) {
+        return -1;
+    }
+    batch->doomed = (int *)malloc(sizeof(int) * nodes->count);
+    if (!batch->doomed) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+    for (size_t i = 0; i < nodes->capacity; i++) {
+        if (nodes->values[i] != NULL) {
+            batch->doomed[batch->doomedCount++] = (int)(uint32_t)nodes->keys[i];
+        }
+    }
+    qsort(batch->doomed, batch->doomedCount, sizeof(int), compareInts);
+    return 0;
 }
 
-// Print all books
-void printBooks(Book *bookHead) {
-    if (!bookHead) {
-        printf("No books in the library.\n");
+// Queue a posting list for filtering, once however often it is touched
+static void postingBatchTouch(PostingBatch *batch, Posting *posting) {
+    if (!posting || posting->marked) {
         return;
     }
-    printf("\n--- Books ---\n");
-    printf("ID | Book Name%*s | ISBN%*s | Example Count\n", MAX_NAME_LEN - 10, "", MAX_ISBN_LEN - 4, "");
-    printf("---|-----------%*s|------%*s|---------------\n", MAX_NAME_LEN - 10, "", MAX_ISBN_LEN - 4, "");
-    Book *temp = bookHead;
-    while (temp != NULL) {
-        int exampleCount = 0;
-        BookExample *example = temp->head;
-        while(example != NULL) {
-            exampleCount++;
-            example = example->next;
+    if (batch->touchedCount == batch->touchedCapacity) {
+        size_t newCapacity = batch->touchedCapacity ? batch->touchedCapacity * 2 : 64;
+        Posting **touched = (Posting **)realloc(batch->touched, sizeof(Posting *) * newCapacity);
+        if (!touched) {
+            perror("Memory re-allocation failed");
+            return;
         }
-        printf("%-2d | %-*s | %-*s | %d\n",
-               temp->bookId, MAX_NAME_LEN - 1, temp->bookName, MAX_ISBN_LEN - 1, temp->ISBN, exampleCount);
-        temp = temp->next;
+        batch->touched = touched;
+        batch->touchedCapacity = newCapacity;
     }
-    printf("-------------\n");
+    posting->marked = 1;
+    batch->touched[batch->touchedCount++] = posting;
 }
 
-// Find a book by ID
-Book *findBookById(Book *bookHead, int bookId) {
-    Book *temp = bookHead;
-    while (temp != NULL) {
-        if (temp->bookId == bookId) {
-            return temp;
-        }
-        temp = temp->next;
+// Filter the doomed IDs out of every touched posting list, decoding and
+// re-encoding each once, and release the batch
+static void postingBatchFinish(PostingBatch *batch) {
+    for (size_t i = 0; i < batch->touchedCount; i++) {
+        batch->touched[i]->marked = 0;
+        postingRemoveIds(batch->touched[i], batch->doomed, batch->doomedCount);
     }
-    return NULL; // Not found
+    free(batch->touched);
+    free(batch->doomed);
 }
 
-// Find a book by ISBN
-Book *findBookByISBN(Book *bookHead, const char *ISBN) {
-    Book *temp = bookHead;
-    while (temp != NULL) {
-        if (strcmp(temp->ISBN, ISBN) == 0) {
-            return temp;
+// Remove the nodes of one table of a delete batch from a word index. A
+// word shared by many of them costs one pass over its list, not one each.
+static void wordIndexRemoveNodes(HashIndex *index, const HashIndex *nodes, size_t nameOffset) {
+    PostingBatch batch;
+    if (!__atomic_load_n(&wordIndexesBuilt, __ATOMIC_ACQUIRE) || postingBatchStart(&batch, nodes) != 0) {
+        return;
+    }
+    for (size_t i = 0; i < nodes->capacity; i++) {
+        if (nodes->values[i] == NULL) {
+            continue;
+        }
+        char word[MAX_WORD_LEN];
+        const char *rest = (const char *)nodes->values[i] + nameOffset;
+        while ((rest = nextWord(rest, word, sizeof(word))) != NULL) {
+            postingBatchTouch(&batch, wordIndexFind(index, word, 0));
         }
-        temp = temp->next;
     }
-    return NULL; // Not found
+    postingBatchFinish(&batch);
 }
 
-// Find a book by name
-Book *findBookByName(Book *bookHead, const char *bookName) {
-    Book *temp = bookHead;
-    while (temp != NULL) {
-        if (strcmp(temp->bookName, bookName) == 0) {
-            return temp;
+// Release the posting lists of a word index
+void wordIndexFree(HashIndex *index) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        Posting *posting = (Posting *)index->values[i];
+        if (posting) {
+            if (posting->capacity != 0) {
+                free(posting->data.bytes);
+            }
+            free(posting);
         }
-        temp = temp->next;
     }
-    return NULL; // Not found
+    hashIndexFree(index);
 }
 
-
-// // Create book examples (called during book loading/adding)
-// void createBookExamples(Book *bookHead) {
-// }
-
-// Print all book examples for all books
-void printBookExamples(Book *bookHead) {
-    if (!bookHead) {
-        printf("No books in the library to show examples.\n");
-        return;
+// Build the word indexes from the lists on first use. Lists in ID order,
+// as the loaders and inserts keep them, fill every posting list by appends.
+static int ensureWordIndexes(Book *bookHead, Author *authorHead) {
+    if (__atomic_load_n(&wordIndexesBuilt, __ATOMIC_ACQUIRE)) {
+        return 0;
     }
-    printf("\n--- Book Examples ---\n");
-    Book *tmp = bookHead;
-    while (tmp != NULL) {
-        printf("Book: %s (ID: %d)\n", tmp->bookName, tmp->bookId);
-        printf("  Example ID | Status (0: Shelf, 1: Borrowed)\n");
-        printf("  -----------|-------------------------------\n");
-        BookExample *tmpExample = tmp->head;
-        while (tmpExample != NULL) {
-            printf("  %-10d | %d\n", tmpExample->exampleId, tmpExample->status);
-            tmpExample = tmpExample->next;
+    int status = 0;
+    pthread_mutex_lock(&wordIndexLock);
+    if (!wordIndexesBuilt) {
+        for (Book *book = bookHead; book != NULL && status == 0; book = book->next) {
+            status = wordIndexPut(&bookWordIndex, book->bookName, book->bookId);
+        }
+        for (Author *author = authorHead; author != NULL && status == 0; author = author->next) {
+            status = wordIndexPut(&authorWordIndex, author->authorName, author->authorId);
+        }
+        if (status == 0) {
+            __atomic_store_n(&wordIndexesBuilt, 1, __ATOMIC_RELEASE);
+        } else {
+            wordIndexFree(&bookWordIndex);
+            wordIndexFree(&authorWordIndex);
         }
-        printf("----------------------------------------\n");
-        tmp = tmp->next;
     }
+    pthread_mutex_unlock(&wordIndexLock);
+    return status;
 }
 
-// Print book examples for a specific book by name
-void printBookExamplesByBookName(Book *bookHead) {
-    char bookName[MAX_NAME_LEN];
-    printf("Enter Book Name to show examples: ");
-    fgets(bookName, sizeof(bookName), stdin);
-    bookName[strcspn(bookName, "\n")] = 0; 
-
-    Book *book = findBookByName(bookHead, bookName);
-    if (!book) {
-        printf("Book '%s' not found.\n", bookName);
-        return;
+// Collect the books of one search word, merging the books of the authors
+// whose name has the word into the books whose title has it
+static int wordHitsCollect(WordHits *hits, const char *word, const BookAuthor *bookAuthorArray, int bookAuthorCount) {
+    Posting *titles = wordIndexFind(&bookWordIndex, word, 0);
+    Posting *authors = wordIndexFind(&authorWordIndex, word, 0);
+    hits->titleCount = titles ? titles->count : 0;
+    hits->titleIds = postingIds(titles);
+    hits->count = 0;
+    hits->ids = NULL;
+    if (hits->titleCount > 0 && !hits->titleIds) {
+        return -1;
+    }
+    int *authorIds = postingIds(authors);
+    if (authors && authors->count > 0 && !authorIds) {
+        return -1;
     }
 
-    printf("\n--- Book Examples for '%s' ---\n", book->bookName);
-    printf("  Example ID | Status (0: Shelf, 1: Borrowed)\n");
-    printf("  -----------|-------------------------------\n");
-    BookExample *tmpExample = book->head;
-    if (!tmpExample) {
-        printf("  No examples available for this book.\n");
-    } else {
-        while (tmpExample != NULL) {
-            printf("  %-10d | %d\n", tmpExample->exampleId, tmpExample->status);
-            tmpExample = tmpExample->next;
+    int capacity = hits->titleCount + (authors ? authors->count : 0) + 16;
+    hits->ids = (int *)malloc(sizeof(int) * capacity);
+    if (!hits->ids) {
+        perror("Memory allocation failed");
+        free(authorIds);
+        return -1;
+    }
+    if (hits->titleCount > 0) {
+        memcpy(hits->ids, hits->titleIds, sizeof(int) * hits->titleCount);
+    }
+    int count = hits->titleCount;
+    for (int i = 0; authors && i < authors->count; i++) {
+        int found = getBooksByAuthor(bookAuthorArray, bookAuthorCount, authorIds[i], hits->ids + count, capacity - count);
+        if (found > capacity - count) {
+            int newCapacity = (count + found) * 2;
+            int *grown = (int *)realloc(hits->ids, sizeof(int) * newCapacity);
+            if (!grown) {
+                perror("Memory re-allocation failed");
+                free(authorIds);
+                return -1;
+            }
+            hits->ids = grown;
+            capacity = newCapacity;
+            found = getBooksByAuthor(bookAuthorArray, bookAuthorCount, authorIds[i], hits->ids + count, capacity - count);
         }
+        count += found;
     }
-    printf("----------------------------------------\n");
+    free(authorIds);
+
+    if (count > hits->titleCount) {
+        qsort(hits->ids, count, sizeof(int), compareInts);
+        int unique = 0;
+        for (int i = 0; i < count; i++) {
+            if (unique == 0 || hits->ids[unique - 1] != hits->ids[i]) {
+                hits->ids[unique++] = hits->ids[i];
+            }
+        }
+        count = unique;
+    }
+    hits->count = count;
+    return 0;
 }
 
+// Find the books having every word of the query in the title or in an
+// author's name, ignoring case and diacritics. Books with more of the words
+// in the title come first, then by ID. Copies up to maxIds book IDs and
+// returns the number of matches.
+size_t findBooksByWords(const char *query, Book *bookHead, Author *authorHead,
+                        const BookAuthor *bookAuthorArray, int bookAuthorCount, int *bookIds, size_t maxIds) {
+    char words[MAX_QUERY_WORDS][MAX_WORD_LEN];
+    int wordCount = 0;
+    const char *rest = query;
+    while (wordCount < MAX_QUERY_WORDS && (rest = nextWord(rest, words[wordCount], MAX_WORD_LEN)) != NULL) {
+        int repeated = 0;
+        for (int i = 0; i < wordCount; i++) {
+            repeated |= strcmp(words[i], words[wordCount]) == 0;
+        }
+        if (!repeated) {
+            wordCount++;
+        }
+    }
+    if (wordCount == 0 || ensureWordIndexes(bookHead, authorHead) != 0) {
+        return 0;
+    }
 
-// Update the status of a specific book example
-void updateBookExampleStatus(Book *bookHead, int bookId, int exampleId, int status) {
-    Book *book = findBookById(bookHead, bookId);
-    if (!book) {
-        printf("Error: Book not found for example status update.\n");
-        return;
+    WordHits hits[MAX_QUERY_WORDS];
+    int collected = 0;
+    size_t total = 0;
+    unsigned char *titleMatches = NULL;
+    for (; collected < wordCount; collected++) {
+        if (wordHitsCollect(&hits[collected], words[collected], bookAuthorArray, bookAuthorCount) != 0 ||
+            hits[collected].count == 0) {
+            collected++;
+            goto done;
+        }
     }
 
-    BookExample *example = book->head;
-    while (example != NULL && example->exampleId != exampleId) {
-        example = example->next;
+    // Intersect starting from the rarest word, galloping through the others
+    int order[MAX_QUERY_WORDS];
+    for (int i = 0; i < wordCount; i++) {
+        int j = i;
+        while (j > 0 && hits[order[j - 1]].count > hits[i].count) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    int *matches = hits[order[0]].ids;
+    total = (size_t)hits[order[0]].count;
+    for (int i = 1; i < wordCount && total > 0; i++) {
+        const WordHits *other = &hits[order[i]];
+        size_t kept = 0, pos = 0;
+        for (size_t j = 0; j < total && pos < (size_t)other->count; j++) {
+            pos = gallopTo(other->ids, other->count, pos, matches[j]);
+            if (pos < (size_t)other->count && other->ids[pos] == matches[j]) {
+                matches[kept++] = matches[j];
+            }
+        }
+        total = kept;
+    }
+    if (total == 0 || maxIds == 0) {
+        goto done;
     }
 
-    if (!example) {
-        printf("Error: Book example not found for status update.\n");
-        return;
+    // Rank by the number of words found in the title
+    titleMatches = (unsigned char *)calloc(total, 1);
+    if (!titleMatches) {
+        perror("Memory allocation failed");
+        total = 0;
+        goto done;
+    }
+    for (int i = 0; i < wordCount; i++) {
+        size_t pos = 0;
+        for (size_t j = 0; j < total && pos < (size_t)hits[i].titleCount; j++) {
+            pos = gallopTo(hits[i].titleIds, hits[i].titleCount, pos, matches[j]);
+            if (pos < (size_t)hits[i].titleCount && hits[i].titleIds[pos] == matches[j]) {
+                titleMatches[j]++;
+            }
+        }
+    }
+    size_t copied = 0;
+    for (int score = wordCount; score >= 0 && copied < maxIds; score--) {
+        for (size_t j = 0; j < total && copied < maxIds; j++) {
+            if (titleMatches[j] == score) {
+                bookIds[copied++] = matches[j];
+            }
+        }
     }
 
-    example->status = status;
+done:
+    free(titleMatches);
+    for (int i = 0; i < collected; i++) {
+        free(hits[i].titleIds);
+        free(hits[i].ids);
+    }
+    return total;
 }
 
 
-// --- Author Functions ---
-
-// Load authors from CSV
-void loadAuthors(Author **authorHead) {
-    FILE *file = fopen("yazarlar.csv", "r");
-    if (!file) {
-        *authorHead = NULL;
-        return;
+// --- Trigram Index Functions ---
+// Fuzzy name search. A name is folded like the word index does it, its
+// words joined by single spaces and padded with a space at both ends. Its
+// trigrams are the three consecutive bytes of that which do not span two
+// words. A name within k edits of the query shares all but at most 3k of
+// the query's trigrams, so candidates come from the posting lists of the
+// query's trigrams and only they are ranked by a bounded edit distance.
+
+#define MAX_FUZZY_DISTANCE 3 // Edits allowed at most, one per four characters of the query
+
+// Fold a name for the trigram index. Returns the length, 0 if it has no words.
+static size_t foldTrigramName(const char *name, char *folded, size_t size) {
+    char word[MAX_WORD_LEN];
+    size_t n = 0;
+    const char *rest = name;
+    while ((rest = nextWord(rest, word, sizeof(word))) != NULL) {
+        size_t length = strlen(word);
+        if (n + 1 + length + 2 > size) {
+            break;
+        }
+        folded[n++] = ' ';
+        memcpy(folded + n, word, length);
+        n += length;
     }
+    if (n == 0) {
+        folded[0] = '\0';
+        return 0;
+    }
+    folded[n++] = ' ';
+    folded[n] = '\0';
+    return n;
+}
 
-    char line[MAX_LINE_LEN];
-    Author *last = NULL;
-
-    
-    fgets(line, sizeof(line), file);
-
-    while (fgets(line, sizeof(line), file)) {
-        Author *newAuthor = (Author *)malloc(sizeof(Author));
-        if (!newAuthor) {
-            perror("Memory allocation failed");
-            break; 
+// Keys of the trigrams of a name, in order and with repeats. keys must
+// hold MAX_FOLDED_LEN entries. Returns the number of keys.
+static size_t nameTrigrams(const char *name, uint32_t *keys) {
+    char folded[MAX_FOLDED_LEN];
+    size_t length = foldTrigramName(name, folded, sizeof(folded));
+    size_t count = 0;
+    for (size_t i = 0; i + 3 <= length; i++) {
+        const unsigned char *p = (const unsigned char *)folded + i;
+        if (p[1] != ' ') {
+            keys[count++] = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
         }
-        newAuthor->next = NULL;
+    }
+    return count;
+}
 
-        // Parse CSV line: authorId,authorName
-        sscanf(line, "%d,%[^\n]", &newAuthor->authorId, newAuthor->authorName);
+// Find the posting list of a trigram, creating an empty one if create is set
+static Posting *trigramIndexFind(TrigramIndex *index, uint32_t key, int create) {
+    Posting *posting = (Posting *)hashIndexGet(&index->trigrams, key);
+    if (posting || !create) {
+        return posting;
+    }
+    posting = (Posting *)calloc(1, sizeof(Posting) + 1);
+    if (!posting) {
+        perror("Memory allocation failed");
+        return NULL;
+    }
+    if (hashIndexInsert(&index->trigrams, key, posting) != 0) {
+        free(posting);
+        return NULL;
+    }
+    return posting;
+}
 
-        if (*authorHead == NULL) {
-            *authorHead = newAuthor;
-            last = newAuthor;
-        } else {
-            last->next = newAuthor;
-            last = newAuthor;
+// Index every trigram of a name under an ID
+static int trigramIndexPut(TrigramIndex *index, const char *name, int id) {
+    uint32_t keys[MAX_FOLDED_LEN];
+    size_t count = nameTrigrams(name, keys);
+    for (size_t i = 0; i < count; i++) {
+        Posting *posting = trigramIndexFind(index, keys[i], 1);
+        if (!posting || postingAdd(posting, id) != 0) {
+            return -1;
         }
     }
-    fclose(file);
+    return 0;
 }
 
-// Save authors to CSV
-void saveAuthors(Author *authorHead) {
-    FILE *file = fopen("yazarlar.csv", "w");
-    if (!file) {
-        perror("Error opening yazarlar.csv for writing");
-        return;
+// Index a new or renamed name, once the table's trigram index is built
+int trigramIndexAdd(TrigramIndex *index, const char *name, int id) {
+    if (!__atomic_load_n(&index->built, __ATOMIC_ACQUIRE)) {
+        return 0;
     }
+    return trigramIndexPut(index, name, id);
+}
 
-    // Write header
-    fprintf(file, "authorId,authorName\n");
-
-    Author *current = authorHead;
-    while (current != NULL) {
-        fprintf(file, "%d,%s\n", current->authorId, current->authorName);
-        current = current->next;
+// Remove an ID from the posting lists of a name's trigrams
+void trigramIndexRemove(TrigramIndex *index, const char *name, int id) {
+    if (!__atomic_load_n(&index->built, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    uint32_t keys[MAX_FOLDED_LEN];
+    size_t count = nameTrigrams(name, keys);
+    for (size_t i = 0; i < count; i++) {
+        Posting *posting = trigramIndexFind(index, keys[i], 0);
+        if (posting) {
+            postingRemoveIds(posting, &id, 1);
+        }
     }
-    fclose(file);
 }
 
-// Add a new author
-void addAuthor(Author **authorHead) {
-    Author *newAuthor = (Author *)malloc(sizeof(Author));
-    if (!newAuthor) {
-        perror("Memory allocation failed");
+// Remove the nodes of one table of a delete batch from its trigram index
+static void trigramIndexRemoveNodes(TrigramIndex *index, const HashIndex *nodes) {
+    PostingBatch batch;
+    if (!__atomic_load_n(&index->built, __ATOMIC_ACQUIRE) || postingBatchStart(&batch, nodes) != 0) {
         return;
     }
-    newAuthor->next = NULL;
-
-    // Find the next available author ID
-    int maxAuthorId = 0;
-    Author *current = *authorHead;
-    while (current != NULL) {
-        if (current->authorId > maxAuthorId) {
-            maxAuthorId = current->authorId;
+    for (size_t i = 0; i < nodes->capacity; i++) {
+        if (nodes->values[i] == NULL) {
+            continue;
+        }
+        uint32_t keys[MAX_FOLDED_LEN];
+        size_t count = nameTrigrams((const char *)nodes->values[i] + index->nameOffset, keys);
+        for (size_t j = 0; j < count; j++) {
+            postingBatchTouch(&batch, trigramIndexFind(index, keys[j], 0));
         }
-        current = current->next;
     }
-    newAuthor->authorId = maxAuthorId + 1;
+    postingBatchFinish(&batch);
+}
 
-    printf("Enter Author Name: ");
-    fgets(newAuthor->authorName, sizeof(newAuthor->authorName), stdin);
-    newAuthor->authorName[strcspn(newAuthor->authorName, "\n")] = 0; 
+// Release the posting lists of a trigram index
+void trigramIndexFree(TrigramIndex *index) {
+    wordIndexFree(&index->trigrams);
+    index->built = 0;
+}
 
-    // Add to the end of the list
-    if (*authorHead == NULL) {
-        *authorHead = newAuthor;
-    } else {
-        current = *authorHead;
-        while (current->next != NULL) {
-            current = current->next;
+// Order of (ID, node) pairs by ID, for qsort
+static int compareIdNodes(const void *a, const void *b) {
+    const IdNode *x = (const IdNode *)a, *y = (const IdNode *)b;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+// Build a trigram index from its table's ID index on first use. The nodes
+// are indexed in ID order so that every posting list fills by appends.
+static int ensureTrigramIndex(TrigramIndex *index) {
+    if (__atomic_load_n(&index->built, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    int status = 0;
+    pthread_mutex_lock(&trigramIndexLock);
+    if (!index->built) {
+        const HashIndex *ids = index->ids;
+        IdNode *nodes = (IdNode *)malloc(sizeof(IdNode) * (ids->count + 1));
+        if (!nodes) {
+            perror("Memory allocation failed");
+            status = -1;
+        } else {
+            size_t count = 0;
+            for (size_t i = 0; i < ids->capacity; i++) {
+                if (ids->values[i] != NULL) {
+                    nodes[count].id = (int)(uint32_t)ids->keys[i];
+                    nodes[count].node = ids->values[i];
+                    count++;
+                }
+            }
+            qsort(nodes, count, sizeof(IdNode), compareIdNodes);
+            for (size_t i = 0; i < count && status == 0; i++) {
+                status = trigramIndexPut(index, (const char *)nodes[i].node + index->nameOffset, nodes[i].id);
+            }
+            free(nodes);
+        }
+        if (status == 0) {
+            __atomic_store_n(&index->built, 1, __ATOMIC_RELEASE);
+        } else {
+            wordIndexFree(&index->trigrams);
         }
-        current->next = newAuthor;
     }
-
-    printf("Author added successfully with ID %d.\n", newAuthor->authorId);
+    pthread_mutex_unlock(&trigramIndexLock);
+    return status;
 }
 
-// Delete an author
-void deleteAuthor(Author **authorHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int deletedAuthorId) {
-    Author *current = *authorHead;
-    Author *prev = NULL;
-    while (current != NULL && current->authorId != deletedAuthorId) {
-        prev = current;
-        current = current->next;
+// Edit distance between a and b, counting insertions, deletions,
+// substitutions and swaps of two neighbouring bytes, or max + 1 if it is
+// above max. Only the band of cells within max of the diagonal is filled,
+// and the search gives up once a whole row of the band is above max.
+static int boundedEditDistance(const char *a, size_t la, const char *b, size_t lb, int max) {
+    if (la > lb + (size_t)max || lb > la + (size_t)max) {
+        return max + 1;
     }
-
-    if (!current) {
-        printf("Author with ID %d not found.\n", deletedAuthorId);
-        return;
+    if (la == 0 || lb == 0) {
+        return (int)(la + lb);
     }
-
-    if (prev == NULL) {
-        *authorHead = current->next; 
-    } else {
-        prev->next = current->next;
+    size_t band = (size_t)max;
+    int rows[3][MAX_FOLDED_LEN + 1];
+    int *before = rows[0], *previous = rows[1], *current = rows[2];
+    for (size_t j = 0; j <= lb; j++) {
+        previous[j] = j <= band ? (int)j : max + 1;
     }
+    for (size_t i = 1; i <= la; i++) {
+        size_t low = i > band ? i - band : 1;
+        size_t high = i + band < lb ? i + band : lb;
+        current[low - 1] = low == 1 && i <= band ? (int)i : max + 1;
+        int rowMin = current[low - 1];
+        for (size_t j = low; j <= high; j++) {
+            int best = previous[j - 1] + (a[i - 1] != b[j - 1]);
+            if (previous[j] + 1 < best) {
+                best = previous[j] + 1;
+            }
+            if (current[j - 1] + 1 < best) {
+                best = current[j - 1] + 1;
+            }
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1] && before[j - 2] + 1 < best) {
+                best = before[j - 2] + 1;
+            }
+            if (best > max) {
+                best = max + 1;
+            }
+            current[j] = best;
+            if (best < rowMin) {
+                rowMin = best;
+            }
+        }
+        if (high < lb) {
+            current[high + 1] = max + 1;
+        }
+        if (rowMin > max) {
+            return max + 1;
+        }
+        int *oldest = before;
+        before = previous;
+        previous = current;
+        current = oldest;
+    }
+    return previous[lb];
+}
 
-    free(current); 
+// Distance between a folded query and a folded name: the whole strings
+// compared, or each query word matched to its closest word of the name and
+// the edits added up, whichever is less. Word matching lets a surname alone
+// or names in another order find the full name.
+static int nameDistance(const char *query, size_t queryLength, const char *name, size_t nameLength, int max) {
+    int total = 0;
+    for (size_t q = 0; q < queryLength && total <= max;) {
+        size_t qEnd = q;
+        while (qEnd < queryLength && query[qEnd] != ' ') {
+            qEnd++;
+        }
+        int wordBest = max - total + 1;
+        for (size_t n = 0; n < nameLength && wordBest > 0;) {
+            size_t nEnd = n;
+            while (nEnd < nameLength && name[nEnd] != ' ') {
+                nEnd++;
+            }
+            int distance = boundedEditDistance(query + q, qEnd - q, name + n, nEnd - n, wordBest - 1);
+            if (distance < wordBest) {
+                wordBest = distance;
+            }
+            n = nEnd + 1;
+        }
+        total += wordBest;
+        q = qEnd + 1;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    int best = boundedEditDistance(query, queryLength, name, nameLength, total <= max ? total - 1 : max);
+    return best < total ? best : total;
+}
 
-   
-    updateBookAuthorAfterAuthorDeletion(bookAuthorArray, *bookAuthorCount, deletedAuthorId);
+// Find the rows of a table whose name is within a few edits of the query,
+// ignoring case and diacritics: one edit per four characters of the query,
+// at most MAX_FUZZY_DISTANCE, so a query under four characters must match
+// a word exactly. Copies the IDs of the closest maxIds names (at most
+// MAX_SEARCH_RESULTS), nearest first, then those sharing more trigrams,
+// then by ID, and returns how many it copied.
+static size_t trigramIndexSearch(TrigramIndex *index, const char *query, int *ids, size_t maxIds) {
+    char folded[MAX_FOLDED_LEN];
+    size_t length = foldTrigramName(query, folded, sizeof(folded));
+    if (length == 0 || maxIds == 0 || ensureTrigramIndex(index) != 0) {
+        return 0;
+    }
+    if (maxIds > MAX_SEARCH_RESULTS) {
+        maxIds = MAX_SEARCH_RESULTS;
+    }
+    const char *bare = folded + 1; // Without the padding
+    size_t bareLength = length - 2;
+    int max = (int)(bareLength / 4);
+    if (max > MAX_FUZZY_DISTANCE) {
+        max = MAX_FUZZY_DISTANCE;
+    }
 
+    // Posting lists of the distinct trigrams, shortest first
+    Posting *lists[MAX_FOLDED_LEN];
+    int listCount = 0;
+    uint32_t trigrams[MAX_FOLDED_LEN];
+    size_t trigramCount = nameTrigrams(query, trigrams);
+    uint32_t keys[MAX_FOLDED_LEN];
+    int keyCount = 0;
+    for (size_t i = 0; i < trigramCount; i++) {
+        uint32_t key = trigrams[i];
+        int seen = 0;
+        for (int k = 0; k < keyCount && !seen; k++) {
+            seen = keys[k] == key;
+        }
+        if (seen) {
+            continue;
+        }
+        keys[keyCount++] = key;
+        Posting *posting = trigramIndexFind(index, key, 0);
+        int count = posting ? posting->count : 0;
+        int j = listCount++;
+        while (j > 0 && (lists[j - 1] ? lists[j - 1]->count : 0) > count) {
+            lists[j] = lists[j - 1];
+            j--;
+        }
+        lists[j] = posting;
+    }
+    int threshold = keyCount - 3 * max;
+    if (threshold < 1) {
+        threshold = 1;
+    }
 
-    printf("Author with ID %d deleted successfully.\n", deletedAuthorId);
+    // A name sharing threshold trigrams is in one of the listCount -
+    // threshold + 1 shortest lists: count over those, then look the
+    // candidates up in the longer lists
+    int shortLists = listCount - threshold + 1;
+    size_t total = 0;
+    for (int i = 0; i < shortLists; i++) {
+        total += lists[i] ? (size_t)lists[i]->count : 0;
+    }
+    int *candidates = (int *)malloc(sizeof(int) * (total + 1));
+    int *shared = (int *)malloc(sizeof(int) * (total + 1));
+    int *merged = (int *)malloc(sizeof(int) * (total + 1));
+    int *mergedShared = (int *)malloc(sizeof(int) * (total + 1));
+    int *listIds = (int *)malloc(sizeof(int) * (total + 1));
+    size_t kept = 0;
+    if (!candidates || !shared || !merged || !mergedShared || !listIds) {
+        perror("Memory allocation failed");
+        goto done;
+    }
+    // The lists are sorted, so merging them in one at a time counts the
+    // lists holding each ID in linear passes
+    size_t count = 0;
+    for (int i = 0; i < shortLists; i++) {
+        if (!lists[i] || lists[i]->count == 0) {
+            continue;
+        }
+        postingDecode(lists[i], listIds);
+        size_t idCount = (size_t)lists[i]->count;
+        size_t a = 0, b = 0, n = 0;
+        while (a < count || b < idCount) {
+            if (b == idCount || (a < count && candidates[a] < listIds[b])) {
+                merged[n] = candidates[a];
+                mergedShared[n++] = shared[a++];
+            } else if (a == count || listIds[b] < candidates[a]) {
+                merged[n] = listIds[b++];
+                mergedShared[n++] = 1;
+            } else {
+                merged[n] = candidates[a];
+                mergedShared[n++] = shared[a++] + 1;
+                b++;
+            }
+        }
+        int *swap = candidates;
+        candidates = merged;
+        merged = swap;
+        swap = shared;
+        shared = mergedShared;
+        mergedShared = swap;
+        count = n;
+    }
+    for (int i = shortLists; i < listCount && count > 0; i++) {
+        int *longIds = postingIds(lists[i]);
+        if (!longIds) {
+            continue;
+        }
+        size_t pos = 0, longCount = (size_t)lists[i]->count;
+        for (size_t j = 0; j < count && pos < longCount; j++) {
+            pos = gallopTo(longIds, longCount, pos, candidates[j]);
+            if (pos < longCount && longIds[pos] == candidates[j]) {
+                shared[j]++;
+            }
+        }
+        free(longIds);
+    }
+
+    // Verify the candidates sharing the most trigrams first, through a
+    // counting sort into merged that keeps ID order within a count. A name
+    // sharing n trigrams is at least (keyCount - n) / 3 edits away, so once
+    // maxIds names are kept the rest are skipped as soon as that bound
+    // reaches the worst distance kept.
+    int bucketStart[MAX_FOLDED_LEN + 1] = { 0 };
+    for (size_t i = 0; i < count; i++) {
+        if (shared[i] >= threshold) {
+            bucketStart[shared[i]]++;
+        }
+    }
+    size_t ordered = 0;
+    for (int n = keyCount; n >= threshold; n--) {
+        size_t inBucket = (size_t)bucketStart[n];
+        bucketStart[n] = (int)ordered;
+        ordered += inBucket;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (shared[i] >= threshold) {
+            merged[bucketStart[shared[i]]++] = (int)i;
+        }
+    }
+    int bestDistance[MAX_SEARCH_RESULTS];
+    for (size_t k = 0; k < ordered; k++) {
+        int i = merged[k];
+        int bound = max;
+        if (kept == maxIds) {
+            bound = bestDistance[kept - 1] - 1;
+            if ((keyCount - shared[i] + 2) / 3 > bound) {
+                break;
+            }
+        }
+        const char *node = (const char *)hashIndexGet(index->ids, (uint32_t)candidates[i]);
+        if (!node) {
+            continue;
+        }
+        char name[MAX_FOLDED_LEN];
+        size_t nameLength = foldTrigramName(node + index->nameOffset, name, sizeof(name));
+        if (nameLength == 0) {
+            continue;
+        }
+        int distance = nameDistance(bare, bareLength, name + 1, nameLength - 2, bound);
+        if (distance > bound) {
+            continue;
+        }
+        // Insert after the kept names as close, which share as many
+        // trigrams or more
+        size_t pos = kept < maxIds ? kept : maxIds - 1;
+        while (pos > 0 && bestDistance[pos - 1] > distance) {
+            ids[pos] = ids[pos - 1];
+            bestDistance[pos] = bestDistance[pos - 1];
+            pos--;
+        }
+        ids[pos] = candidates[i];
+        bestDistance[pos] = distance;
+        if (kept < maxIds) {
+            kept++;
+        }
+    }
+
+done:
+    free(candidates);
+    free(shared);
+    free(merged);
+    free(mergedShared);
+    free(listIds);
+    return kept;
 }
 
+size_t findBooksBySimilarName(const char *query, int *bookIds, size_t maxIds) {
+    return trigramIndexSearch(&bookTrigramIndex, query, bookIds, maxIds);
+}
 
-// Update author information
-void updateAuthor(Author *authorHead) {
-    int authorId;
-    printf("Enter Author ID to update: ");
-    scanf("%d", &authorId);
-    getchar(); 
+size_t findAuthorsBySimilarName(const char *query, int *authorIds, size_t maxIds) {
+    return trigramIndexSearch(&authorTrigramIndex, query, authorIds, maxIds);
+}
 
-    Author *author = findAuthorById(authorHead, authorId);
-    if (!author) {
-        printf("Author with ID %d not found.\n", authorId);
-        return;
-    }
+size_t findStudentsBySimilarName(const char *query, int *studentIds, size_t maxIds) {
+    return trigramIndexSearch(&studentTrigramIndex, query, studentIds, maxIds);
+}
 
-    printf("Enter new Author Name (leave blank to keep current '%s'): ", author->authorName);
-    char newAuthorName[MAX_NAME_LEN];
-    fgets(newAuthorName, sizeof(newAuthorName), stdin);
-    newAuthorName[strcspn(newAuthorName, "\n")] = 0; 
-    if (strlen(newAuthorName) > 0) {
-        strcpy(author->authorName, newAuthorName);
+
+// Free allocated memory. Every node of a table lives in that table's pool,
+// so a whole table is released chunk by chunk without walking the list.
+void freeBookLoans(BookLoan *head) {
+    (void)head;
+    poolDestroy(&loanPool);
+}
+
+void freeStudents(Student *head) {
+    (void)head;
+    poolDestroy(&studentPool);
+}
+
+void freeAuthors(Author *head) {
+    (void)head;
+    poolDestroy(&authorPool);
+}
+
+// Books with more than 64 examples own a separately allocated bitmap
+void freeBooks(Book *head) {
+    if (wideBookCount > 0) {
+        for (Book *temp = head; temp != NULL; temp = temp->next) {
+            freeBookExamples(temp);
+        }
     }
+    poolDestroy(&bookPool);
+}
 
-    printf("Author with ID %d updated successfully.\n", authorId);
+
+// --- CSV Reader Functions ---
+// The loaders map each CSV file into memory and split it in place, without
+// copying lines or calling sscanf. Lines that do not parse are reported on
+// stderr with their line number and skipped.
+
+#define CSV_MAX_REPORTED 10 // Malformed lines reported per file before only counting
+
+// Scalar delimiter search, also used for the tail of the vector versions
+const char *csvFindDelimiterScalar(const char *p, const char *end) {
+    while (p < end && *p != ',' && *p != '\n') {
+        p++;
+    }
+    return p;
 }
 
-// Print all authors
-void printAuthors(Author *authorHead) {
-    if (!authorHead) {
-        printf("No authors in the system.\n");
-        return;
+#if defined(__x86_64__)
+// SSE2 is part of the x86-64 baseline
+const char *csvFindDelimiterSse2(const char *p, const char *end) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, comma),
+                                                                 _mm_cmpeq_epi8(chunk, newline)));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
     }
-    printf("\n--- Authors ---\n");
-    printf("ID | Author Name\n");
-    printf("---|------------\n");
-    Author *temp = authorHead;
-    while (temp != NULL) {
-        printf("%-2d | %s\n", temp->authorId, temp->authorName);
-        temp = temp->next;
+    return csvFindDelimiterScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char *csvFindDelimiterAvx2(const char *p, const char *end) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)p);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, comma),
+                                                                       _mm256_cmpeq_epi8(chunk, newline)));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
     }
-    printf("---------------\n");
+    return csvFindDelimiterSse2(p, end);
+}
+#endif
+
+// Delimiter search picked for this CPU; set once, loaders run on threads
+static const char *(*csvFindDelimiterImpl)(const char *, const char *);
+static pthread_once_t csvFindDelimiterOnce = PTHREAD_ONCE_INIT;
+
+// Pick the widest delimiter search the CPU supports
+void csvFindDelimiterInit(void) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    csvFindDelimiterImpl = __builtin_cpu_supports("avx2") ? csvFindDelimiterAvx2 : csvFindDelimiterSse2;
+#else
+    csvFindDelimiterImpl = csvFindDelimiterScalar;
+#endif
 }
 
-// Find an author by ID
-Author *findAuthorById(Author *authorHead, int authorId) {
-    Author *temp = authorHead;
-    while (temp != NULL) {
-        if (temp->authorId == authorId) {
-            return temp;
+// Pointer to the first ',' or '\n' in [p, end), or end if there is none
+const char *csvFindDelimiter(const char *p, const char *end) {
+    pthread_once(&csvFindDelimiterOnce, csvFindDelimiterInit);
+    return csvFindDelimiterImpl(p, end);
+}
+
+// Map a CSV file for reading. Returns 0 on success, -1 if the file cannot
+// be opened. An empty file opens as a file without records.
+int csvOpen(CsvReader *reader, const char *fileName) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fileName = fileName;
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror("Error mapping CSV file");
+            close(fd);
+            return -1;
         }
-        temp = temp->next;
+        madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+        reader->data = (const char *)data;
+        reader->size = (size_t)st.st_size;
     }
-    return NULL; // Not found
+    close(fd); // The mapping stays valid
+    return 0;
 }
 
-// Find an author by name
-Author *findAuthorByName(Author *authorHead, const char *authorName) {
-    Author *temp = authorHead;
-    while (temp != NULL) {
-        if (strcmp(temp->authorName, authorName) == 0) {
-            return temp;
+// Split the next non-blank line into at most fieldLimit fields; the last
+// field takes the rest of the line, commas included. Returns 1 if a line
+// was read, 0 at the end of the file.
+int csvNextRecord(CsvReader *reader, int fieldLimit) {
+    const char *end = reader->data + reader->size;
+    if (fieldLimit > CSV_MAX_FIELDS) {
+        fieldLimit = CSV_MAX_FIELDS;
+    }
+
+    while (reader->pos < reader->size) {
+        const char *p = reader->data + reader->pos;
+        const char *lineEnd;
+        reader->lineNumber++;
+        reader->fieldCount = 0;
+
+        for (;;) {
+            const char *q;
+            if (reader->fieldCount == fieldLimit - 1) {
+                q = (const char *)memchr(p, '\n', (size_t)(end - p));
+                if (!q) {
+                    q = end;
+                }
+            } else {
+                q = csvFindDelimiter(p, end);
+            }
+            reader->fields[reader->fieldCount] = p;
+            reader->lengths[reader->fieldCount] = (size_t)(q - p);
+            reader->fieldCount++;
+            if (q == end || *q == '\n') {
+                lineEnd = q;
+                break;
+            }
+            p = q + 1;
         }
-        temp = temp->next;
+        reader->pos = (size_t)(lineEnd - reader->data) + (lineEnd < end);
+
+        // Tolerate CRLF line endings
+        size_t *lastLength = &reader->lengths[reader->fieldCount - 1];
+        if (*lastLength > 0 && reader->fields[reader->fieldCount - 1][*lastLength - 1] == '\r') {
+            (*lastLength)--;
+        }
+        if (reader->fieldCount == 1 && *lastLength == 0) {
+            continue; // Blank line
+        }
+        return 1;
     }
-    return NULL; // Not found
+    return 0;
 }
 
-// --- Book-Author Link Functions ---
+// Split field index of the current record in two at its last comma, so
+// that a text field followed by numeric fields may itself contain commas.
+// Returns 0 on success, -1 if the field has no comma.
+int csvSplitField(CsvReader *reader, int index) {
+    if (reader->fieldCount == CSV_MAX_FIELDS) {
+        return -1;
+    }
+    const char *field = reader->fields[index];
+    size_t comma = reader->lengths[index];
+    while (comma > 0 && field[comma - 1] != ',') {
+        comma--;
+    }
+    if (comma == 0) {
+        return -1;
+    }
 
-// Load book-author links from CSV
-void loadBookAuthors(BookAuthor **bookAuthorArray, int *count) {
-    FILE *file = fopen("kitap_yazar.csv", "r");
-    if (!file) {
-        *bookAuthorArray = NULL;
-        *count = 0;
-        return;
+    for (int i = reader->fieldCount; i > index + 1; i--) {
+        reader->fields[i] = reader->fields[i - 1];
+        reader->lengths[i] = reader->lengths[i - 1];
     }
+    reader->fields[index + 1] = field + comma;
+    reader->lengths[index + 1] = reader->lengths[index] - comma;
+    reader->lengths[index] = comma - 1;
+    reader->fieldCount++;
+    return 0;
+}
 
-    char line[MAX_LINE_LEN];
-    *count = 0;
+// Report the current line as malformed; it is skipped by the caller
+void csvReportMalformed(CsvReader *reader, const char *reason) {
+    reader->malformed++;
+    if (reader->malformed <= CSV_MAX_REPORTED) {
+        fprintf(stderr, "%s:%d: %s, line skipped\n", reader->fileName, reader->lineNumber, reason);
+    }
+}
 
-    // Count lines to determine array size (excluding header)
-    while (fgets(line, sizeof(line), file)) {
-        (*count)++;
+// Unmap the file and summarize the malformed lines not reported one by one
+void csvClose(CsvReader *reader) {
+    if (reader->malformed > CSV_MAX_REPORTED) {
+        fprintf(stderr, "%s: %d more malformed lines skipped\n",
+                reader->fileName, reader->malformed - CSV_MAX_REPORTED);
     }
-    fseek(file, 0, SEEK_SET); // Reset file pointer
+    if (reader->data) {
+        munmap((void *)reader->data, reader->size);
+    }
+    reader->data = NULL;
+    reader->size = 0;
+}
 
-    if (*count > 1) { // If there are entries besides the header
-        *bookAuthorArray = (BookAuthor *)malloc(sizeof(BookAuthor) * (*count - 1));
-        if (!*bookAuthorArray) {
-            perror("Memory allocation failed");
-            *count = 0;
-            fclose(file);
-            return;
-        }
+// Parse a decimal integer field, allowing surrounding spaces.
+// Returns 0 on success, -1 if the field is not a number or out of range.
+int csvParseInt(const char *field, size_t length, int *value) {
+    const char *p = field;
+    const char *end = field + length;
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    while (end > p && end[-1] == ' ') {
+        end--;
+    }
 
-        
-        fgets(line, sizeof(line), file);
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end) {
+        return -1;
+    }
 
-        int i = 0;
-        while (fgets(line, sizeof(line), file)) {
-            sscanf(line, "%d,%d", &(*bookAuthorArray)[i].bookId, &(*bookAuthorArray)[i].authorId);
-            i++;
+    int64_t result = 0;
+    for (; p < end; p++) {
+        unsigned digit = (unsigned)(*p - '0');
+        if (digit > 9) {
+            return -1;
+        }
+        result = result * 10 + digit;
+        if (result > (int64_t)INT32_MAX + negative) {
+            return -1;
         }
-        *count = i; // Update count to actual number of entries
-    } else {
-        *bookAuthorArray = NULL;
-        *count = 0;
     }
+    *value = (int)(negative ? -result : result);
+    return 0;
+}
 
-    fclose(file);
+// Copy a text field into a fixed-size buffer.
+// Returns 0 on success, -1 if the field does not fit.
+int csvCopyField(const char *field, size_t length, char *dest, size_t size) {
+    if (length >= size) {
+        return -1;
+    }
+    memcpy(dest, field, length);
+    dest[length] = '\0';
+    return 0;
 }
 
-// Save book-author links to CSV
-void saveBookAuthors(BookAuthor *bookAuthorArray, int count) {
-    FILE *file = fopen("kitap_yazar.csv", "w");
+
+// --- File Rewrite Functions ---
+// Files are never rewritten in place: the new contents go to "<name>.tmp",
+// which is synced to disk and then renamed over the old file. A crash at
+// any point leaves either the old or the new file, never a truncated one.
+
+// Record that tables changed and need to be written again
+void markTablesDirty(unsigned tables) {
+    // Writers of different tables may run at the same time
+    __atomic_fetch_or(&csvDirtyTables, tables, __ATOMIC_RELAXED);
+    __atomic_fetch_or(&snapshotDirtyTables, tables, __ATOMIC_RELAXED);
+}
+
+// Open the temporary file for rewriting fileName. Returns NULL on error.
+FILE *openForRewrite(const char *fileName) {
+    char tempName[MAX_NAME_LEN];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", fileName);
+    FILE *file = fopen(tempName, "wb");
     if (!file) {
-        perror("Error opening kitap_yazar.csv for writing");
-        return;
+        fprintf(stderr, "Error opening %s for writing: %s\n", tempName, strerror(errno));
     }
+    return file;
+}
 
-    // Write header
-    fprintf(file, "bookId,authorId\n");
-
-    for (int i = 0; i < count; i++) {
-        fprintf(file, "%d,%d\n", bookAuthorArray[i].bookId, bookAuthorArray[i].authorId);
+// Sync and close the temporary file and rename it over fileName.
+// Returns 0 on success, -1 on error (the old file is left untouched).
+int finishRewrite(FILE *file, const char *fileName) {
+    char tempName[MAX_NAME_LEN];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", fileName);
+    int failed = ferror(file) || fflush(file) != 0 || fsync(fileno(file)) != 0;
+    if (fclose(file) != 0) {
+        failed = 1;
     }
-    fclose(file);
+    if (failed || rename(tempName, fileName) != 0) {
+        fprintf(stderr, "Error writing %s: %s\n", fileName, strerror(errno));
+        remove(tempName);
+        return -1;
+    }
+    return 0;
 }
 
+// Close and delete the temporary file after a failed rewrite
+void abandonRewrite(FILE *file, const char *fileName) {
+    char tempName[MAX_NAME_LEN];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", fileName);
+    fprintf(stderr, "Error writing %s\n", tempName);
+    fclose(file);
+    remove(tempName);
+}
 
-// Add a new book-author link
-void addBookAuthor(BookAuthor **bookAuthorArray, int *count, int bookId, int authorId) {
-    // Check if the link already exists
-    for (int i = 0; i < *count; i++) {
-        if ((*bookAuthorArray)[i].bookId == bookId && (*bookAuthorArray)[i].authorId == authorId) {
-            printf("This book-author link already exists.\n");
-            return;
-        }
+// Keep the current fileName as "<name>.bak" (replacing an older backup)
+// before it is rewritten. Returns 0 on success, -1 on error.
+int keepBackup(const char *fileName) {
+    char backupName[MAX_NAME_LEN];
+    snprintf(backupName, sizeof(backupName), "%s.bak", fileName);
+    if ((unlink(backupName) != 0 && errno != ENOENT) || link(fileName, backupName) != 0) {
+        fprintf(stderr, "Error keeping %s as %s: %s\n", fileName, backupName, strerror(errno));
+        return -1;
     }
+    fprintf(stderr, "%s had malformed lines; the old file is kept as %s.\n", fileName, backupName);
+    return 0;
+}
 
-    // Resize the array
-    *bookAuthorArray = (BookAuthor *)realloc(*bookAuthorArray, sizeof(BookAuthor) * (*count + 1));
-    if (!*bookAuthorArray) {
-        perror("Memory re-allocation failed");
-        return;
+// Sync the working directory, making the renames durable
+void syncDirectory() {
+    int fd = open(".", O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
     }
+}
 
-    // Add the new link
-    (*bookAuthorArray)[*count].bookId = bookId;
-    (*bookAuthorArray)[*count].authorId = authorId;
-    (*count)++;
 
-    printf("Book-author link added successfully.\n");
+// --- Output Buffer Functions ---
+// The save functions format rows into large reusable buffers with the
+// helpers below instead of calling fprintf per row, and write the buffer
+// out once it passes OUT_FLUSH_SIZE.
+
+// Make room for extra more bytes. Returns 0 on success, -1 on allocation
+// failure.
+int outReserve(OutBuffer *out, size_t extra) {
+    if (out->size + extra <= out->capacity) {
+        return 0;
+    }
+    size_t newCapacity = out->capacity ? out->capacity * 2 : OUT_FLUSH_SIZE + OUT_ROW_MAX;
+    while (newCapacity < out->size + extra) {
+        newCapacity *= 2;
+    }
+    char *grown = (char *)realloc(out->data, newCapacity);
+    if (!grown) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+    out->data = grown;
+    out->capacity = newCapacity;
+    return 0;
 }
 
-// Update a book-author link (Less common, usually delete and re-add)
-void updateBookAuthor(BookAuthor *bookAuthorArray, int count) {
-    printf("Updating book-author links is typically done by deleting and re-adding.\n");
+// Write the buffered bytes to file and empty the buffer.
+// Returns 0 on success, -1 on a write error.
+int outFlush(OutBuffer *out, FILE *file) {
+    if (out->size > 0 && fwrite(out->data, 1, out->size, file) != out->size) {
+        return -1;
+    }
+    out->size = 0;
+    return 0;
 }
 
-// Print all book-author links
-void printBookAuthors(BookAuthor *bookAuthorArray, int count) {
-    if (count == 0) {
-        printf("No book-author links recorded.\n");
-        return;
+void outFree(OutBuffer *out) {
+    free(out->data);
+    out->data = NULL;
+    out->size = 0;
+    out->capacity = 0;
+}
+
+// Format a decimal integer at p and return the end. The caller reserves
+// room (OUT_ROW_MAX covers a row of integers and two names).
+char *outInt(char *p, int value) {
+    char digits[12];
+    int count = 0;
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    if (value < 0) {
+        *p++ = '-';
     }
-    printf("\n--- Book-Author Links ---\n");
-    printf("Book ID | Author ID\n");
-    printf("--------|----------\n");
-    for (int i = 0; i < count; i++) {
-        printf("%-7d | %d\n", bookAuthorArray[i].bookId, bookAuthorArray[i].authorId);
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    while (count > 0) {
+        *p++ = digits[--count];
     }
-    printf("-------------------------\n");
+    return p;
 }
 
-// Update book-author array after an author is deleted
-void updateBookAuthorAfterAuthorDeletion(BookAuthor **bookAuthorArray, int bookAuthorCount, int authorId) {
-    int newCount = 0;
-    for (int i = 0; i < bookAuthorCount; i++) {
-        if ((*bookAuthorArray)[i].authorId != authorId) {
-            (*bookAuthorArray)[newCount] = (*bookAuthorArray)[i];
-            newCount++;
-        }
+// Format a day number as DD.MM.YYYY at p (see formatDate)
+char *outDate(char *p, int32_t days) {
+    int year, month, day;
+    civilFromDays(days, &year, &month, &day);
+    unsigned y = (unsigned)year % 10000u;
+    p[0] = (char)('0' + (unsigned)day / 10 % 10);
+    p[1] = (char)('0' + (unsigned)day % 10);
+    p[2] = '.';
+    p[3] = (char)('0' + (unsigned)month / 10 % 10);
+    p[4] = (char)('0' + (unsigned)month % 10);
+    p[5] = '.';
+    p[6] = (char)('0' + y / 1000);
+    p[7] = (char)('0' + y / 100 % 10);
+    p[8] = (char)('0' + y / 10 % 10);
+    p[9] = (char)('0' + y % 10);
+    return p + 10;
+}
+
+// Copy a string at p and return the end
+char *outText(char *p, const char *text) {
+    size_t length = strlen(text);
+    memcpy(p, text, length);
+    return p + length;
+}
+
+// Number of threads used to format a table in parallel
+int saveThreadCount() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return 1;
     }
-    // Resize the array if necessary (optional, but good practice)
-    if (newCount < bookAuthorCount) {
-        *bookAuthorArray = (BookAuthor *)realloc(*bookAuthorArray, sizeof(BookAuthor) * newCount);
-        if (!*bookAuthorArray && newCount > 0) {
-             perror("Memory re-allocation failed after author deletion");
-        }
+    return cpus > SAVE_MAX_THREADS ? SAVE_MAX_THREADS : (int)cpus;
+}
+
+
+// --- Book Loan Functions ---
+
+// Key of a book example in the example loan index
+static uint64_t exampleKey(int bookId, int exampleId) {
+    return ((uint64_t)(uint32_t)bookId << 32) | (uint32_t)exampleId;
+}
+
+// Find the loan chain for a key, creating an empty one if requested
+static LoanChain *getLoanChain(HashIndex *index, uint64_t key, int create) {
+    LoanChain *chain = (LoanChain *)hashIndexGet(index, key);
+    if (chain || !create) {
+        return chain;
+    }
+    chain = (LoanChain *)poolAlloc(&loanChainPool);
+    if (!chain) {
+        perror("Memory allocation failed");
+        return NULL;
+    }
+    memset(chain, 0, sizeof(*chain));
+    if (hashIndexInsert(index, key, chain) != 0) {
+        poolFree(&loanChainPool, chain);
+        return NULL;
     }
+    return chain;
 }
 
-// Update book-author array after a book is deleted
-void updateBookAuthorAfterBookDeletion(BookAuthor **bookAuthorArray, int bookAuthorCount, int bookId) {
-    int newCount = 0;
-    for (int i = 0; i < bookAuthorCount; i++) {
-        if ((*bookAuthorArray)[i].bookId != bookId) {
-            (*bookAuthorArray)[newCount] = (*bookAuthorArray)[i];
-            newCount++;
+// Add a loan to the student and example indexes and, while it is active,
+// to the due-date heap. Loans must be indexed in loan order so that
+// histories stay newest first.
+void indexBookLoan(BookLoan *loan) {
+    loan->heapPos = -1;
+    if (loan->returned == 0) {
+        loanHeapPush(&dueHeap, loan);
+    }
+    loan->nextByStudent = NULL;
+    loan->nextByExample = NULL;
+    loan->prevActive = NULL;
+    loan->nextActive = NULL;
+
+    LoanChain *studentChain = getLoanChain(&studentLoanIndex, (uint32_t)loan->studentId, 1);
+    LoanChain *exampleChain = getLoanChain(&exampleLoanIndex, exampleKey(loan->bookId, loan->exampleId), 1);
+    if (studentChain) {
+        loan->nextByStudent = studentChain->history;
+        studentChain->history = loan;
+        if (loan->returned == 0) {
+            loan->prevActive = studentChain->activeTail;
+            if (studentChain->activeTail) {
+                studentChain->activeTail->nextActive = loan;
+            } else {
+                studentChain->activeHead = loan;
+            }
+            studentChain->activeTail = loan;
+            studentChain->activeCount++;
         }
     }
-    // Resize the array if necessary (optional, but good practice)
-    if (newCount < bookAuthorCount) {
-         *bookAuthorArray = (BookAuthor *)realloc(*bookAuthorArray, sizeof(BookAuthor) * newCount);
-         if (!*bookAuthorArray && newCount > 0) {
-             perror("Memory re-allocation failed after book deletion");
-             // Handle error
-         }
+    if (exampleChain) {
+        loan->nextByExample = exampleChain->history;
+        exampleChain->history = loan;
+        if (loan->returned == 0) {
+            exampleChain->activeCount++;
+        }
     }
 }
 
+// Heap order: earlier due date first, ties broken by loan ID
+static int loanHeapLess(const BookLoan *a, const BookLoan *b) {
+    if (a->returnDay != b->returnDay) {
+        return a->returnDay < b->returnDay;
+    }
+    return a->loanId < b->loanId;
+}
 
-// --- Student Functions ---
+// Place a loan at a heap position and record it in the loan
+static void loanHeapSet(LoanHeap *heap, size_t pos, BookLoan *loan) {
+    heap->loans[pos] = loan;
+    loan->heapPos = (int)pos;
+}
 
-// Load students from CSV
-void loadStudents(Student **studentHead) {
-    FILE *file = fopen("ogrenciler.csv", "r");
-    if (!file) {
-        *studentHead = NULL;
-        return;
+static void loanHeapSiftUp(LoanHeap *heap, size_t pos) {
+    BookLoan *loan = heap->loans[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!loanHeapLess(loan, heap->loans[parent])) {
+            break;
+        }
+        loanHeapSet(heap, pos, heap->loans[parent]);
+        pos = parent;
     }
+    loanHeapSet(heap, pos, loan);
+}
 
-    char line[MAX_LINE_LEN];
-    Student *last = NULL;
+static void loanHeapSiftDown(LoanHeap *heap, size_t pos) {
+    BookLoan *loan = heap->loans[pos];
+    while (1) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && loanHeapLess(heap->loans[child + 1], heap->loans[child])) {
+            child++;
+        }
+        if (!loanHeapLess(heap->loans[child], loan)) {
+            break;
+        }
+        loanHeapSet(heap, pos, heap->loans[child]);
+        pos = child;
+    }
+    loanHeapSet(heap, pos, loan);
+}
 
-    
-    fgets(line, sizeof(line), file);
+// Add an active loan to the heap. Returns 0 on success, -1 on failure.
+int loanHeapPush(LoanHeap *heap, BookLoan *loan) {
+    if (heap->count == heap->capacity) {
+        size_t newCapacity = heap->capacity ? heap->capacity * 2 : 64;
+        BookLoan **loans = (BookLoan **)realloc(heap->loans, sizeof(BookLoan *) * newCapacity);
+        if (!loans) {
+            perror("Memory re-allocation failed");
+            return -1;
+        }
+        heap->loans = loans;
+        heap->capacity = newCapacity;
+    }
+    heap->loans[heap->count] = loan;
+    loanHeapSiftUp(heap, heap->count++);
+    return 0;
+}
 
-    while (fgets(line, sizeof(line), file)) {
-        Student *newStudent = (Student *)malloc(sizeof(Student));
-        if (!newStudent) {
+// Remove a loan from anywhere in the heap
+void loanHeapRemove(LoanHeap *heap, BookLoan *loan) {
+    if (loan->heapPos < 0) {
+        return;
+    }
+    size_t pos = (size_t)loan->heapPos;
+    loan->heapPos = -1;
+    heap->count--;
+    if (pos == heap->count) {
+        return;
+    }
+    loanHeapSet(heap, pos, heap->loans[heap->count]);
+    loanHeapSiftDown(heap, pos);
+    loanHeapSiftUp(heap, (size_t)heap->loans[pos]->heapPos);
+}
+
+static int compareLoansByDue(const void *a, const void *b) {
+    const BookLoan *x = *(BookLoan *const *)a;
+    const BookLoan *y = *(BookLoan *const *)b;
+    return loanHeapLess(x, y) ? -1 : (loanHeapLess(y, x) ? 1 : 0);
+}
+
+// Collect the loans due on or before maxDay, sorted by due date. Only the
+// matching part of the heap is visited, so the cost is O(k log k) in the
+// number of results. The caller frees *results.
+size_t loanHeapCollect(const LoanHeap *heap, int32_t maxDay, BookLoan ***results) {
+    *results = NULL;
+    if (heap->count == 0 || heap->loans[0]->returnDay > maxDay) {
+        return 0;
+    }
+
+    size_t count = 0, capacity = 16;
+    size_t *stack = (size_t *)malloc(sizeof(size_t) * capacity);
+    BookLoan **found = (BookLoan **)malloc(sizeof(BookLoan *) * capacity);
+    if (!stack || !found) {
+        perror("Memory allocation failed");
+        free(stack);
+        free(found);
+        return 0;
+    }
+
+    // Every heap node above the cut-off is a result, and the stack never
+    // holds more entries than results found plus one
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        size_t pos = stack[--top];
+        if (count + 2 > capacity) {
+            capacity *= 2;
+            size_t *newStack = (size_t *)realloc(stack, sizeof(size_t) * capacity);
+            BookLoan **newFound = (BookLoan **)realloc(found, sizeof(BookLoan *) * capacity);
+            if (newStack) {
+                stack = newStack;
+            }
+            if (newFound) {
+                found = newFound;
+            }
+            if (!newStack || !newFound) {
+                perror("Memory re-allocation failed");
+                break;
+            }
+        }
+        found[count++] = heap->loans[pos];
+        for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap->count; child++) {
+            if (heap->loans[child]->returnDay <= maxDay) {
+                stack[top++] = child;
+            }
+        }
+    }
+    free(stack);
+
+    qsort(found, count, sizeof(BookLoan *), compareLoansByDue);
+    *results = found;
+    return count;
+}
+
+// Release the memory held by a loan heap
+void loanHeapFree(LoanHeap *heap) {
+    free(heap->loans);
+    heap->loans = NULL;
+    heap->count = 0;
+    heap->capacity = 0;
+}
+
+// Drop a loan from the active sets once it has been returned
+void unindexActiveLoan(BookLoan *loan) {
+    loanHeapRemove(&dueHeap, loan);
+    LoanChain *studentChain = getLoanChain(&studentLoanIndex, (uint32_t)loan->studentId, 0);
+    LoanChain *exampleChain = getLoanChain(&exampleLoanIndex, exampleKey(loan->bookId, loan->exampleId), 0);
+    if (studentChain) {
+        if (loan->prevActive) {
+            loan->prevActive->nextActive = loan->nextActive;
+        } else {
+            studentChain->activeHead = loan->nextActive;
+        }
+        if (loan->nextActive) {
+            loan->nextActive->prevActive = loan->prevActive;
+        } else {
+            studentChain->activeTail = loan->prevActive;
+        }
+        loan->prevActive = NULL;
+        loan->nextActive = NULL;
+        studentChain->activeCount--;
+    }
+    if (exampleChain) {
+        exampleChain->activeCount--;
+    }
+}
+
+// Add a loan read by a loader to the end of the list and to the indexes.
+// Returns 0 on success, 1 if the loan ID is taken (the node is not linked).
+int linkLoadedLoan(BookLoan *newLoan, BookLoan **loanHead, BookLoan **last) {
+    if (hashIndexInsert(&loanIdIndex, (uint32_t)newLoan->loanId, newLoan) == 1) {
+        return 1;
+    }
+    indexBookLoan(newLoan);
+
+    if (newLoan->loanId >= nextLoanId) {
+        nextLoanId = newLoan->loanId + 1;
+    }
+
+    newLoan->next = NULL;
+    if (*loanHead == NULL) {
+        *loanHead = newLoan;
+    } else {
+        (*last)->next = newLoan;
+    }
+    *last = newLoan;
+    return 0;
+}
+
+// Parse the current record of a loan file into the data fields of loan.
+// CSV line: loanId,bookId,exampleId,studentId,loanDate,returnDate,returned
+// Returns 0 on success, -1 after reporting the line as malformed.
+int parseLoanRecord(CsvReader *reader, BookLoan *loan) {
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    if (reader->fieldCount != 7) {
+        csvReportMalformed(reader, "expected 7 fields");
+        return -1;
+    }
+    if (csvParseInt(reader->fields[0], reader->lengths[0], &loan->loanId) != 0 ||
+        csvParseInt(reader->fields[1], reader->lengths[1], &loan->bookId) != 0 ||
+        csvParseInt(reader->fields[2], reader->lengths[2], &loan->exampleId) != 0 ||
+        csvParseInt(reader->fields[3], reader->lengths[3], &loan->studentId) != 0) {
+        csvReportMalformed(reader, "invalid ID");
+        return -1;
+    }
+    if (csvCopyField(reader->fields[4], reader->lengths[4], loanDate, sizeof(loanDate)) != 0 ||
+        csvCopyField(reader->fields[5], reader->lengths[5], returnDate, sizeof(returnDate)) != 0 ||
+        parseDate(loanDate, &loan->loanDay) != 0 || parseDate(returnDate, &loan->returnDay) != 0) {
+        csvReportMalformed(reader, "invalid date");
+        return -1;
+    }
+    if (csvParseInt(reader->fields[6], reader->lengths[6], &loan->returned) != 0 ||
+        (loan->returned != 0 && loan->returned != 1)) {
+        csvReportMalformed(reader, "returned flag must be 0 or 1");
+        return -1;
+    }
+    return 0;
+}
+
+// Load book loans from CSV
+void loadBookLoans(BookLoan **loanHead) {
+    CsvReader reader;
+    if (csvOpen(&reader, "kitap_odunc.csv") != 0) {
+        *loanHead = NULL;
+        return;
+    }
+
+    BookLoan *last = NULL;
+
+    // Skip header row
+    csvNextRecord(&reader, 1);
+
+    while (csvNextRecord(&reader, 7)) {
+        BookLoan parsed = { 0 };
+        if (parseLoanRecord(&reader, &parsed) != 0) {
+            continue;
+        }
+
+        BookLoan *newLoan = (BookLoan *)poolAlloc(&loanPool);
+        if (!newLoan) {
             perror("Memory allocation failed");
-            break; 
+            break; // Exit loop on allocation failure
+        }
+        *newLoan = parsed;
+        if (linkLoadedLoan(newLoan, loanHead, &last) != 0) {
+            csvReportMalformed(&reader, "duplicate loan ID");
+            poolFree(&loanPool, newLoan);
+            continue;
+        }
+    }
+    loanTail = last;
+    if (reader.malformed > 0) {
+        __atomic_fetch_or(&csvSkippedTables, TABLE_LOANS, __ATOMIC_RELAXED);
+    }
+    csvClose(&reader);
+}
+
+// Save book loans to CSV. Returns 0 on success, -1 on error.
+int saveBookLoans(BookLoan *loanHead) {
+    FILE *file = openForRewrite("kitap_odunc.csv");
+    if (!file) {
+        return -1;
+    }
+
+    // Split the list into chunks of SAVE_CHUNK_ROWS loans
+    size_t chunkCount = 0, chunkCapacity = 0, lastRows = 0;
+    BookLoan **starts = NULL;
+    int failed = 0;
+    for (BookLoan *current = loanHead; current != NULL; current = current->next) {
+        if (lastRows == SAVE_CHUNK_ROWS || chunkCount == 0) {
+            if (chunkCount == chunkCapacity) {
+                chunkCapacity = chunkCapacity ? chunkCapacity * 2 : 64;
+                BookLoan **grown = (BookLoan **)realloc(starts, sizeof(BookLoan *) * chunkCapacity);
+                if (!grown) {
+                    perror("Memory allocation failed");
+                    failed = 1;
+                    break;
+                }
+                starts = grown;
+            }
+            starts[chunkCount++] = current;
+            lastRows = 0;
+        }
+        lastRows++;
+    }
+
+    // Write header
+    if (!failed && fputs("loanId,bookId,exampleId,studentId,loanDate,returnDate,returned\n", file) == EOF) {
+        failed = 1;
+    }
+
+    // Chunks are formatted a round at a time, one per thread, into two sets
+    // of buffers: while one round is being formatted, the previous one is
+    // written out in order.
+    int threads = saveThreadCount();
+    LoanChunk rounds[2][SAVE_MAX_THREADS];
+    pthread_t workers[2][SAVE_MAX_THREADS];
+    int started[2][SAVE_MAX_THREADS];
+    size_t roundChunks[2] = { 0, 0 };
+    memset(rounds, 0, sizeof(rounds));
+    memset(started, 0, sizeof(started));
+
+    size_t roundCount = failed ? 0 : (chunkCount + threads - 1) / threads;
+    for (size_t round = 0; round <= roundCount; round++) {
+        int current = (int)(round % 2);
+        int previous = 1 - current;
+
+        // Start formatting this round
+        roundChunks[current] = 0;
+        for (int t = 0; round < roundCount && t < threads; t++) {
+            size_t index = round * threads + t;
+            if (index >= chunkCount) {
+                break;
+            }
+            LoanChunk *chunk = &rounds[current][t];
+            chunk->first = starts[index];
+            chunk->rows = index + 1 < chunkCount ? SAVE_CHUNK_ROWS : lastRows;
+            chunk->failed = 0;
+            started[current][t] = pthread_create(&workers[current][t], NULL, formatLoanChunk, chunk) == 0;
+            if (!started[current][t]) {
+                formatLoanChunk(chunk); // Format it here if no thread is available
+            }
+            roundChunks[current]++;
+        }
+
+        // Write the previous round while this one is formatted
+        for (size_t t = 0; round > 0 && t < roundChunks[previous]; t++) {
+            LoanChunk *chunk = &rounds[previous][t];
+            if (started[previous][t]) {
+                pthread_join(workers[previous][t], NULL);
+                started[previous][t] = 0;
+            }
+            if (chunk->failed || (!failed && outFlush(&chunk->out, file) != 0)) {
+                failed = 1;
+            }
+        }
+    }
+
+    for (int set = 0; set < 2; set++) {
+        for (int t = 0; t < SAVE_MAX_THREADS; t++) {
+            outFree(&rounds[set][t].out);
+        }
+    }
+    free(starts);
+    if (failed) {
+        abandonRewrite(file, "kitap_odunc.csv");
+        return -1;
+    }
+    return finishRewrite(file, "kitap_odunc.csv");
+}
+
+// Thread entry: format one chunk of loans as CSV rows into its buffer
+void *formatLoanChunk(void *arg) {
+    LoanChunk *chunk = (LoanChunk *)arg;
+    BookLoan *current = chunk->first;
+    chunk->out.size = 0;
+    for (size_t i = 0; i < chunk->rows && current != NULL; i++, current = current->next) {
+        if (outReserve(&chunk->out, OUT_ROW_MAX) != 0) {
+            chunk->failed = 1;
+            break;
+        }
+        char *p = outLoanRow(chunk->out.data + chunk->out.size, current);
+        chunk->out.size = (size_t)(p - chunk->out.data);
+    }
+    return NULL;
+}
+
+// Format a loan as a CSV row at p and return the end
+char *outLoanRow(char *p, const BookLoan *loan) {
+    p = outInt(p, loan->loanId);
+    *p++ = ',';
+    p = outInt(p, loan->bookId);
+    *p++ = ',';
+    p = outInt(p, loan->exampleId);
+    *p++ = ',';
+    p = outInt(p, loan->studentId);
+    *p++ = ',';
+    p = outDate(p, loan->loanDay);
+    *p++ = ',';
+    p = outDate(p, loan->returnDay);
+    *p++ = ',';
+    p = outInt(p, loan->returned);
+    *p++ = '\n';
+    return p;
+}
+
+// Add a new book loan
+void addBookLoan(BookLoan **loanHead, Book *bookHead) {
+    int studentId, bookId, exampleId;
+
+    printf("Enter Student ID: ");
+    scanf("%d", &studentId);
+    getchar(); 
+
+    printf("Enter Book ID: ");
+    scanf("%d", &bookId);
+    getchar(); 
+
+    printf("Enter Example ID (0 for first available): ");
+    scanf("%d", &exampleId);
+    getchar(); 
+
+    int32_t today = currentDay();
+    int status = insertLoan(loanHead, bookHead, 0, studentId, bookId, exampleId,
+                            today, today + LOAN_PERIOD_DAYS, NULL);
+    if (status == OP_NOT_FOUND) {
+        printf("Book not found.\n");
+    } else if (status == OP_UNAVAILABLE) {
+        printf("Book example not available for loan.\n");
+    } else if (status == OP_OK) {
+        printf("Book loaned successfully.\n");
+    }
+}
+
+// Record a loan and mark the example as borrowed. loanId 0 takes the next
+// ID from the sequence and exampleId 0 the first example on the shelf.
+// Returns OP_OK (the loan in *result if result is not NULL), OP_NOT_FOUND
+// if the book does not exist, OP_UNAVAILABLE if the example is not on the
+// shelf, OP_DUPLICATE if the loan ID is taken, or OP_NO_MEMORY.
+int insertLoan(BookLoan **loanHead, Book *bookHead, int loanId, int studentId, int bookId, int exampleId,
+               int32_t loanDay, int32_t returnDay, BookLoan **result) {
+    Book *book = findBookById(bookHead, bookId);
+    if (!book) {
+        return OP_NOT_FOUND;
+    }
+
+    // Claim the example before recording the loan; of two borrows racing
+    // for the same example only one wins the claim. The claim takes no
+    // lock, and recording the loan holds loanInsertLock only briefly, so
+    // borrows run side by side under a read lock on loans.
+    exampleId = claimBookExample(book, exampleId);
+    if (exampleId == 0) {
+        return OP_UNAVAILABLE;
+    }
+
+    pthread_mutex_lock(&loanInsertLock);
+    if (loanId != 0 && hashIndexGet(&loanIdIndex, (uint32_t)loanId)) {
+        pthread_mutex_unlock(&loanInsertLock);
+        releaseBookExample(book, exampleId);
+        return OP_DUPLICATE;
+    }
+    BookLoan *newLoan = (BookLoan *)poolAlloc(&loanPool);
+    if (!newLoan) {
+        perror("Memory allocation failed");
+        pthread_mutex_unlock(&loanInsertLock);
+        releaseBookExample(book, exampleId);
+        return OP_NO_MEMORY;
+    }
+    newLoan->next = NULL;
+
+    newLoan->loanId = loanId != 0 ? loanId : nextLoanId;
+    if (hashIndexInsert(&loanIdIndex, (uint32_t)newLoan->loanId, newLoan) < 0) {
+        perror("Memory allocation failed");
+        poolFree(&loanPool, newLoan);
+        pthread_mutex_unlock(&loanInsertLock);
+        releaseBookExample(book, exampleId);
+        return OP_NO_MEMORY;
+    }
+    if (newLoan->loanId >= nextLoanId) {
+        nextLoanId = newLoan->loanId + 1;
+    }
+
+    newLoan->bookId = bookId;
+    newLoan->exampleId = exampleId;
+    newLoan->studentId = studentId;
+    newLoan->loanDay = loanDay;
+    newLoan->returnDay = returnDay;
+    newLoan->returned = 0; // Not returned yet
+    indexBookLoan(newLoan);
+
+    // Add to the end of the list
+    if (*loanHead == NULL) {
+        *loanHead = newLoan;
+    } else {
+        loanTail->next = newLoan;
+    }
+    loanTail = newLoan;
+
+    journalLoanAdd(newLoan);
+    pthread_mutex_unlock(&loanInsertLock);
+    if (result) {
+        *result = newLoan;
+    }
+    return OP_OK;
+}
+
+// Return a book
+void returnBook(BookLoan **loanHead, Book *bookHead) {
+    int loanId;
+    printf("Enter Loan ID to return: ");
+    scanf("%d", &loanId);
+    getchar(); 
+
+    int status = *loanHead ? closeLoan(bookHead, loanId, currentDay()) : OP_NOT_FOUND;
+    if (status == OP_NOT_FOUND) {
+        printf("Loan with ID %d not found.\n", loanId);
+    } else if (status == OP_RETURNED) {
+        printf("Book for Loan ID %d has already been returned.\n", loanId);
+    } else {
+        printf("Book returned successfully.\n");
+        BookLoan *loan = (BookLoan *)hashIndexGet(&loanIdIndex, (uint32_t)loanId);
+        Book *book = findBookById(bookHead, loan->bookId);
+        if (!book || getBookExampleStatus(book, loan->exampleId) < 0) {
+            printf("Note: book %d example %d does not exist, so nothing was put back on the shelf.\n",
+                   loan->bookId, loan->exampleId);
+        }
+    }
+}
+
+// Mark a loan as returned on day and put the example back on the shelf.
+// The late days the penalty tick has not charged yet are added to the
+// student's penalty. Prints nothing. Returns OP_OK, OP_NOT_FOUND or
+// OP_RETURNED if it was already returned.
+int closeLoan(Book *bookHead, int loanId, int32_t day) {
+    BookLoan *current = (BookLoan *)hashIndexGet(&loanIdIndex, (uint32_t)loanId);
+
+    if (!current) {
+        return OP_NOT_FOUND;
+    }
+
+    if (current->returned == 1) {
+        return OP_RETURNED;
+    }
+
+    // Update loan status
+    current->returned = 1;
+    unindexActiveLoan(current);
+    chargeLateDays(current, day);
+
+    // Put the example back on the shelf; a loan whose book or example no
+    // longer exists is still closed
+    Book *book = findBookById(bookHead, current->bookId);
+    if (book) {
+        releaseBookExample(book, current->exampleId);
+    }
+
+    journalLoanReturn(loanId, day);
+    return OP_OK;
+}
+
+
+// Print all book loans
+void printBookLoans(BookLoan *loanHead) {
+    if (!loanHead) {
+        printf("No book loans recorded.\n");
+        return;
+    }
+    printf("\n--- Book Loans ---\n");
+    printf("ID | Book ID | Example ID | Student ID | Loan Date | Return Date | Returned\n");
+    printf("---|---------|------------|------------|-----------|-------------|---------\n");
+    BookLoan *tmp = loanHead;
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    while (tmp != NULL) {
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("%-2d | %-7d | %-10d | %-10d | %-9s | %-11s | %d\n",
+               tmp->loanId, tmp->bookId, tmp->exampleId, tmp->studentId,
+               loanDate, returnDate, tmp->returned);
+        tmp = tmp->next;
+    }
+    printf("-------------------\n");
+    if (access(ARCHIVE_DIR, F_OK) == 0) {
+        printf("Returned loans older than %d days are archived in " ARCHIVE_DIR "/ and shown in the loan histories.\n",
+               LOAN_ARCHIVE_DAYS);
+    }
+}
+
+// Print overdue book loans
+void printOverdueLoans(BookLoan *loanHead) {
+    (void)loanHead;
+    int32_t today = currentDay();
+
+    printf("\n--- Overdue Book Loans ---\n");
+    printf("ID | Book ID | Example ID | Student ID | Loan Date | Return Date\n");
+    printf("---|---------|------------|------------|-----------|-------------\n");
+
+    // Loans due strictly before today, earliest first
+    BookLoan **overdue;
+    size_t count = loanHeapCollect(&dueHeap, today - 1, &overdue);
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    for (size_t i = 0; i < count; i++) {
+        BookLoan *tmp = overdue[i];
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("%-2d | %-7d | %-10d | %-10d | %-9s | %-11s\n",
+               tmp->loanId, tmp->bookId, tmp->exampleId, tmp->studentId,
+               loanDate, returnDate);
+    }
+    free(overdue);
+
+    if (count == 0) {
+        printf("No overdue book loans.\n");
+    }
+    printf("--------------------------\n");
+}
+
+// Print the active loans that fall due between today and N days from now
+void printLoansDueWithin(BookLoan *loanHead, int days) {
+    (void)loanHead;
+    int32_t today = currentDay();
+
+    printf("\n--- Loans Due Within %d Days ---\n", days);
+    printf("ID | Book ID | Example ID | Student ID | Loan Date | Return Date\n");
+    printf("---|---------|------------|------------|-----------|-------------\n");
+
+    BookLoan **due;
+    size_t count = loanHeapCollect(&dueHeap, today + days, &due);
+    int foundDue = 0;
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    for (size_t i = 0; i < count; i++) {
+        BookLoan *tmp = due[i];
+        if (tmp->returnDay < today) {
+            continue; // Already overdue
+        }
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("%-2d | %-7d | %-10d | %-10d | %-9s | %-11s\n",
+               tmp->loanId, tmp->bookId, tmp->exampleId, tmp->studentId,
+               loanDate, returnDate);
+        foundDue = 1;
+    }
+    free(due);
+
+    if (!foundDue) {
+        printf("No loans due in this period.\n");
+    }
+    printf("-------------------------------\n");
+}
+
+
+// Check if a specific book example is returned
+int isBookReturned(BookLoan *loanHead, int bookId, int exampleId) {
+    (void)loanHead;
+    LoanChain *chain = getLoanChain(&exampleLoanIndex, exampleKey(bookId, exampleId), 0);
+    if (chain && chain->activeCount > 0) {
+        return 0; // Found an active loan for this example
+    }
+    return 1; // No active loan found, assumed returned or never borrowed
+}
+
+// Get the duration of a loan in days
+int getLoanDuration(BookLoan *loanHead, int loanId) {
+    BookLoan *temp = loanHead ? (BookLoan *)hashIndexGet(&loanIdIndex, (uint32_t)loanId) : NULL;
+    if (temp != NULL) {
+        return calculateDays(temp->loanDay, currentDay()); // Use current date for calculation
+    }
+    return -1; // Loan not found
+}
+
+// Get the number of active loans for a student
+int getLoanCountForStudent(BookLoan *loanHead, int studentId) {
+    (void)loanHead;
+    // A borrow may be recording a loan for the student at the same time
+    pthread_mutex_lock(&loanInsertLock);
+    LoanChain *chain = getLoanChain(&studentLoanIndex, (uint32_t)studentId, 0);
+    int count = chain ? chain->activeCount : 0;
+    pthread_mutex_unlock(&loanInsertLock);
+    return count;
+}
+
+// Print every loan a student has made, newest first, the archived ones
+// included
+void printStudentLoanHistory(int studentId) {
+    LoanChain *chain = getLoanChain(&studentLoanIndex, (uint32_t)studentId, 0);
+    BookLoan *recent = chain ? chain->history : NULL;
+    BookLoan *archived;
+    size_t archivedCount = readArchivedLoans(studentId, 0, 0, &archived);
+    if (!recent && archivedCount == 0) {
+        printf("No loans recorded for student %d.\n", studentId);
+        free(archived);
+        return;
+    }
+    printf("\n--- Loan History for Student %d ---\n", studentId);
+    printf("ID | Book ID | Example ID | Loan Date | Return Date | Returned\n");
+    printf("---|---------|------------|-----------|-------------|---------\n");
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    size_t next = 0;
+    while (recent || next < archivedCount) {
+        BookLoan *tmp;
+        if (recent && (next == archivedCount || recent->loanId > archived[next].loanId)) {
+            tmp = recent;
+            recent = recent->nextByStudent;
+        } else {
+            tmp = &archived[next++];
+        }
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("%-2d | %-7d | %-10d | %-9s | %-11s | %d\n",
+               tmp->loanId, tmp->bookId, tmp->exampleId, loanDate, returnDate, tmp->returned);
+    }
+    printf("-----------------------------------\n");
+    free(archived);
+}
+
+// Print every loan of one book example, newest first, the archived ones
+// included
+void printExampleLoanHistory(int bookId, int exampleId) {
+    LoanChain *chain = getLoanChain(&exampleLoanIndex, exampleKey(bookId, exampleId), 0);
+    BookLoan *recent = chain ? chain->history : NULL;
+    BookLoan *archived;
+    size_t archivedCount = readArchivedLoans(0, bookId, exampleId, &archived);
+    if (!recent && archivedCount == 0) {
+        printf("No loans recorded for book %d, example %d.\n", bookId, exampleId);
+        free(archived);
+        return;
+    }
+    printf("\n--- Loan History for Book %d, Example %d ---\n", bookId, exampleId);
+    printf("ID | Student ID | Loan Date | Return Date | Returned\n");
+    printf("---|------------|-----------|-------------|---------\n");
+    char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+    size_t next = 0;
+    while (recent || next < archivedCount) {
+        BookLoan *tmp;
+        if (recent && (next == archivedCount || recent->loanId > archived[next].loanId)) {
+            tmp = recent;
+            recent = recent->nextByExample;
+        } else {
+            tmp = &archived[next++];
+        }
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("%-2d | %-10d | %-9s | %-11s | %d\n",
+               tmp->loanId, tmp->studentId, loanDate, returnDate, tmp->returned);
+    }
+    printf("--------------------------------------------\n");
+    free(archived);
+}
+
+
+// --- Loan Archive Functions ---
+// Returned loans whose loan date is more than LOAN_ARCHIVE_DAYS days ago
+// leave memory at the next checkpoint. They are appended to
+// arsiv/odunc_YYYY-MM.csv, one file per month of the loan date, in the
+// format of kitap_odunc.csv. Archive files are only ever appended to and
+// are read on demand by the loan histories. After a crash between the
+// append and the save of kitap_odunc.csv the same loans are archived
+// again; readers skip the duplicates.
+
+// 1 if a loan is due for the archive
+static int loanArchivable(const BookLoan *loan, int32_t cutoff) {
+    return loan->returned == 1 && loan->loanDay < cutoff;
+}
+
+// Month of a day number as year * 12 + month - 1
+static int archiveMonth(int32_t days) {
+    int year, month, day;
+    civilFromDays(days, &year, &month, &day);
+    return year * 12 + month - 1;
+}
+
+// Archive order: loan date, then loan ID
+static int compareLoansByDay(const void *a, const void *b) {
+    const BookLoan *x = *(BookLoan *const *)a;
+    const BookLoan *y = *(BookLoan *const *)b;
+    if (x->loanDay != y->loanDay) {
+        return x->loanDay < y->loanDay ? -1 : 1;
+    }
+    return (x->loanId > y->loanId) - (x->loanId < y->loanId);
+}
+
+// History order: newest loan ID first
+static int compareLoansByIdDesc(const void *a, const void *b) {
+    const BookLoan *x = (const BookLoan *)a;
+    const BookLoan *y = (const BookLoan *)b;
+    return (x->loanId < y->loanId) - (x->loanId > y->loanId);
+}
+
+// Append loans sorted by compareLoansByDay to their archive files and sync
+// them. Returns 0 on success, -1 on error.
+int appendArchive(BookLoan **loans, size_t count) {
+    if (mkdir(ARCHIVE_DIR, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error creating " ARCHIVE_DIR ": %s\n", strerror(errno));
+        return -1;
+    }
+
+    OutBuffer out = { NULL, 0, 0 };
+    int failed = 0;
+    size_t i = 0;
+    while (i < count && !failed) {
+        int month = archiveMonth(loans[i]->loanDay);
+        char fileName[MAX_NAME_LEN];
+        snprintf(fileName, sizeof(fileName), ARCHIVE_DIR "/odunc_%04d-%02d.csv", month / 12, month % 12 + 1);
+        FILE *file = fopen(fileName, "ab");
+        if (!file) {
+            fprintf(stderr, "Error opening %s for appending: %s\n", fileName, strerror(errno));
+            failed = 1;
+            break;
+        }
+
+        // Write header into a new file
+        struct stat st;
+        if (fstat(fileno(file), &st) != 0 ||
+            (st.st_size == 0 && fputs("loanId,bookId,exampleId,studentId,loanDate,returnDate,returned\n", file) == EOF)) {
+            failed = 1;
+        }
+
+        for (; i < count && !failed && archiveMonth(loans[i]->loanDay) == month; i++) {
+            if (outReserve(&out, OUT_ROW_MAX) != 0) {
+                failed = 1;
+                break;
+            }
+            out.size = (size_t)(outLoanRow(out.data + out.size, loans[i]) - out.data);
+            if (out.size >= OUT_FLUSH_SIZE && outFlush(&out, file) != 0) {
+                failed = 1;
+            }
+        }
+        if (failed || outFlush(&out, file) != 0 || fflush(file) != 0 || fdatasync(fileno(file)) != 0) {
+            failed = 1;
+        }
+        if (fclose(file) != 0) {
+            failed = 1;
+        }
+        if (failed) {
+            fprintf(stderr, "Error writing %s\n", fileName);
+        }
+    }
+    outFree(&out);
+
+    // Make new archive files durable
+    int fd = open(ARCHIVE_DIR, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    return failed ? -1 : 0;
+}
+
+// Unlink the loans due for the archive from every history of a loan index
+static void dropArchivedLoans(HashIndex *index, int byStudent, int32_t cutoff) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        LoanChain *chain = (LoanChain *)index->values[i];
+        if (!chain) {
+            continue;
+        }
+        BookLoan **link = &chain->history;
+        while (*link != NULL) {
+            BookLoan **next = byStudent ? &(*link)->nextByStudent : &(*link)->nextByExample;
+            if (loanArchivable(*link, cutoff)) {
+                *link = *next;
+            } else {
+                link = next;
+            }
+        }
+    }
+}
+
+// Move the loans due for the archive out of memory. Called by
+// checkpointTables, with the loans table locked. Returns the number of
+// loans archived; if the archive cannot be written, none leaves memory.
+size_t archiveOldLoans(BookLoan **loanHead, int32_t today) {
+    int32_t cutoff = today - LOAN_ARCHIVE_DAYS;
+    size_t count = 0, capacity = 0;
+    BookLoan **loans = NULL;
+    for (BookLoan *current = *loanHead; current != NULL; current = current->next) {
+        if (!loanArchivable(current, cutoff)) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            BookLoan **grown = (BookLoan **)realloc(loans, sizeof(BookLoan *) * capacity);
+            if (!grown) {
+                perror("Memory allocation failed");
+                free(loans);
+                return 0;
+            }
+            loans = grown;
+        }
+        loans[count++] = current;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    qsort(loans, count, sizeof(BookLoan *), compareLoansByDay);
+    int failed = appendArchive(loans, count) != 0;
+    free(loans);
+    if (failed) {
+        return 0;
+    }
+
+    // Unlink them from the histories, then from the list
+    dropArchivedLoans(&studentLoanIndex, 1, cutoff);
+    dropArchivedLoans(&exampleLoanIndex, 0, cutoff);
+    BookLoan *prev = NULL;
+    BookLoan *next;
+    for (BookLoan *current = *loanHead; current != NULL; current = next) {
+        next = current->next;
+        if (!loanArchivable(current, cutoff)) {
+            prev = current;
+            continue;
+        }
+        if (prev == NULL) {
+            *loanHead = next;
+        } else {
+            prev->next = next;
+        }
+        hashIndexRemove(&loanIdIndex, (uint32_t)current->loanId);
+        poolFree(&loanPool, current);
+    }
+    loanTail = prev;
+    markTablesDirty(TABLE_LOANS);
+    return count;
+}
+
+// Read the archived loans of a student, or of a book example if studentId
+// is 0, newest first. Loans that are also in memory and duplicates are
+// left out. Returns the number of loans in *results, which the caller
+// frees.
+size_t readArchivedLoans(int studentId, int bookId, int exampleId, BookLoan **results) {
+    size_t count = 0, capacity = 0;
+    int failed = 0;
+    *results = NULL;
+    DIR *dir = opendir(ARCHIVE_DIR);
+    if (!dir) {
+        return 0;
+    }
+
+    int keyField = studentId != 0 ? 3 : 1;
+    int key = studentId != 0 ? studentId : bookId;
+    struct dirent *entry;
+    while (!failed && (entry = readdir(dir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (strncmp(entry->d_name, "odunc_", 6) != 0 || length < 10 ||
+            strcmp(entry->d_name + length - 4, ".csv") != 0) {
+            continue;
+        }
+        char fileName[sizeof(ARCHIVE_DIR) + sizeof(entry->d_name)];
+        snprintf(fileName, sizeof(fileName), ARCHIVE_DIR "/%s", entry->d_name);
+        CsvReader reader;
+        if (csvOpen(&reader, fileName) != 0) {
+            continue;
+        }
+
+        // Skip header row
+        csvNextRecord(&reader, 1);
+
+        while (csvNextRecord(&reader, 7)) {
+            // Check the key column before parsing the whole row
+            int id;
+            if (reader.fieldCount != 7 ||
+                csvParseInt(reader.fields[keyField], reader.lengths[keyField], &id) != 0 || id != key) {
+                continue;
+            }
+            BookLoan loan = { 0 };
+            if (parseLoanRecord(&reader, &loan) != 0 || (studentId == 0 && loan.exampleId != exampleId) ||
+                hashIndexGet(&loanIdIndex, (uint32_t)loan.loanId)) {
+                continue;
+            }
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                BookLoan *grown = (BookLoan *)realloc(*results, sizeof(BookLoan) * capacity);
+                if (!grown) {
+                    perror("Memory allocation failed");
+                    failed = 1;
+                    break;
+                }
+                *results = grown;
+            }
+            (*results)[count++] = loan;
+        }
+        csvClose(&reader);
+    }
+    closedir(dir);
+
+    if (count > 1) {
+        qsort(*results, count, sizeof(BookLoan), compareLoansByIdDesc);
+        size_t kept = 1;
+        for (size_t i = 1; i < count; i++) {
+            if ((*results)[i].loanId != (*results)[kept - 1].loanId) {
+                (*results)[kept++] = (*results)[i];
+            }
+        }
+        count = kept;
+    }
+    return count;
+}
+
+
+// --- Penalty Functions ---
+// A student is charged one penalty day for every day a loan is late. A
+// loan returned late is charged when it comes back; a loan still out is
+// charged by the daily penalty tick for the days since the previous tick.
+// Both charge only the days after lastPenaltyDay that the other has not,
+// so the total for a loan is its days past the due date. Ticks and returns
+// are journaled with their day and replayed to the same charges.
+
+// Add a student to the penalized set
+void penalizedAdd(Student *student) {
+    student->prevPenalized = penalizedTail;
+    student->nextPenalized = NULL;
+    if (penalizedTail) {
+        penalizedTail->nextPenalized = student;
+    } else {
+        penalizedHead = student;
+    }
+    penalizedTail = student;
+}
+
+// Remove a student from the penalized set
+void penalizedRemove(Student *student) {
+    if (student->prevPenalized) {
+        student->prevPenalized->nextPenalized = student->nextPenalized;
+    } else {
+        penalizedHead = student->nextPenalized;
+    }
+    if (student->nextPenalized) {
+        student->nextPenalized->prevPenalized = student->prevPenalized;
+    } else {
+        penalizedTail = student->prevPenalized;
+    }
+    student->prevPenalized = NULL;
+    student->nextPenalized = NULL;
+}
+
+// Set a student's penalty days, moving the student in or out of the
+// penalized set
+void setStudentPenalty(Student *student, int penaltyDays) {
+    if (student->penaltyDays > 0 && penaltyDays <= 0) {
+        penalizedRemove(student);
+    } else if (student->penaltyDays <= 0 && penaltyDays > 0) {
+        penalizedAdd(student);
+    }
+    student->penaltyDays = penaltyDays;
+}
+
+// Days a loan is late on day
+static int lateDays(const BookLoan *loan, int32_t day) {
+    return day > loan->returnDay ? day - loan->returnDay : 0;
+}
+
+// Charge the student of a loan for its late days after lastPenaltyDay up
+// to day. Returns the days charged.
+int chargeLateDays(const BookLoan *loan, int32_t day) {
+    int charge = lateDays(loan, day) - lateDays(loan, lastPenaltyDay);
+    Student *student = (Student *)hashIndexGet(&studentIdIndex, (uint32_t)loan->studentId);
+    if (charge <= 0 || !student) {
+        return 0;
+    }
+    setStudentPenalty(student, student->penaltyDays + charge);
+    markTablesDirty(TABLE_STUDENTS);
+    return charge;
+}
+
+// Charge every loan that is overdue on day for its late days since the
+// last tick. The overdue loans are the top of the due-date heap, so the
+// loans not yet due are never visited. A tick for a day already ticked
+// only schedules the next one.
+void runPenaltyTick(int32_t day) {
+    if (day > lastPenaltyDay) {
+        BookLoan **overdue;
+        size_t count = loanHeapCollect(&dueHeap, day - 1, &overdue);
+        for (size_t i = 0; i < count; i++) {
+            chargeLateDays(overdue[i], day);
+        }
+        free(overdue);
+        lastPenaltyDay = day;
+        markTablesDirty(TABLE_STUDENTS); // Also saves lastPenaltyDay
+        journalPenaltyTick(day);
+    }
+
+    int year, month, dayOfMonth;
+    civilFromDays(currentDay() + 1, &year, &month, &dayOfMonth);
+    struct tm midnight = { 0 };
+    midnight.tm_year = year - 1900;
+    midnight.tm_mon = month - 1;
+    midnight.tm_mday = dayOfMonth;
+    midnight.tm_isdst = -1;
+    __atomic_store_n(&nextPenaltyTick, mktime(&midnight), __ATOMIC_RELEASE);
+}
+
+// 1 once the day has changed since the last penalty tick
+int penaltyTickDue() {
+    return time(NULL) >= __atomic_load_n(&nextPenaltyTick, __ATOMIC_ACQUIRE);
+}
+
+
+// --- Book Functions ---
+
+// Add a book read by a loader to the end of the list and to the indexes.
+// The name index is sorted by the loader once all books are in.
+// Returns 0 on success, 1 if the book ID is taken (the node is not linked).
+int linkLoadedBook(Book *newBook, Book **bookHead, Book **last) {
+    if (hashIndexInsert(&bookIdIndex, (uint32_t)newBook->bookId, newBook) == 1) {
+        return 1;
+    }
+    nameIndexAppend(&bookNameIndex, newBook->bookName, newBook);
+    uint64_t key = isbnKey(newBook->ISBN);
+    if (key != 0 && hashIndexInsert(&isbnIndex, key, newBook) == 1) {
+        fprintf(stderr, "Warning: book %d has the same ISBN as another book (%s).\n", newBook->bookId, newBook->ISBN);
+    }
+
+    if (newBook->bookId >= nextBookId) {
+        nextBookId = newBook->bookId + 1;
+    }
+
+    newBook->next = NULL;
+    if (*bookHead == NULL) {
+        *bookHead = newBook;
+    } else {
+        (*last)->next = newBook;
+    }
+    *last = newBook;
+    return 0;
+}
+
+// Load books from CSV
+void loadBooks(Book **bookHead) {
+    CsvReader reader;
+    if (csvOpen(&reader, "kitaplar.csv") != 0) {
+        *bookHead = NULL;
+        return;
+    }
+
+    Book *last = NULL;
+
+    // Skip header row
+    csvNextRecord(&reader, 1);
+
+    // CSV line: bookId,bookName,ISBN,exampleCount (the name may contain
+    // commas, so ISBN and exampleCount are split off from the right)
+    while (csvNextRecord(&reader, 2)) {
+        int bookId, exampleCount;
+        if (reader.fieldCount != 2 || csvSplitField(&reader, 1) != 0 || csvSplitField(&reader, 1) != 0) {
+            csvReportMalformed(&reader, "expected 4 fields");
+            continue;
+        }
+        if (csvParseInt(reader.fields[0], reader.lengths[0], &bookId) != 0) {
+            csvReportMalformed(&reader, "invalid book ID");
+            continue;
+        }
+        if (csvParseInt(reader.fields[3], reader.lengths[3], &exampleCount) != 0 || exampleCount < 0) {
+            csvReportMalformed(&reader, "invalid example count");
+            continue;
+        }
+        if (reader.lengths[1] >= MAX_NAME_LEN || reader.lengths[2] >= MAX_ISBN_LEN) {
+            csvReportMalformed(&reader, "book name or ISBN too long");
+            continue;
+        }
+
+        Book *newBook = (Book *)poolAlloc(&bookPool);
+        if (!newBook) {
+            perror("Memory allocation failed");
+            break; 
+        }
+        newBook->next = NULL;
+        newBook->bookId = bookId;
+        csvCopyField(reader.fields[1], reader.lengths[1], newBook->bookName, sizeof(newBook->bookName));
+        csvCopyField(reader.fields[2], reader.lengths[2], newBook->ISBN, sizeof(newBook->ISBN));
+        if (createBookExamples(newBook, exampleCount) != 0) {
+            poolFree(&bookPool, newBook);
+            break;
+        }
+        if (linkLoadedBook(newBook, bookHead, &last) != 0) {
+            csvReportMalformed(&reader, "duplicate book ID");
+            freeBookExamples(newBook);
+            poolFree(&bookPool, newBook);
+            continue;
+        }
+    }
+    bookTail = last;
+    nameIndexSort(&bookNameIndex);
+    if (reader.malformed > 0) {
+        __atomic_fetch_or(&csvSkippedTables, TABLE_BOOKS, __ATOMIC_RELAXED);
+    }
+    csvClose(&reader);
+}
+
+// Save books to CSV. Returns 0 on success, -1 on error.
+int saveBooks(Book *bookHead) {
+    FILE *file = openForRewrite("kitaplar.csv");
+    if (!file) {
+        return -1;
+    }
+
+    OutBuffer out = { NULL, 0, 0 };
+    int failed = outReserve(&out, OUT_ROW_MAX) != 0;
+
+    // Write header
+    if (!failed) {
+        out.size = (size_t)(outText(out.data, "bookId,bookName,ISBN,exampleCount\n") - out.data);
+    }
+
+    for (Book *currentBook = bookHead; currentBook != NULL && !failed; currentBook = currentBook->next) {
+        if (outReserve(&out, OUT_ROW_MAX) != 0) {
+            failed = 1;
+            break;
+        }
+        char *p = out.data + out.size;
+        p = outInt(p, currentBook->bookId);
+        *p++ = ',';
+        p = outText(p, currentBook->bookName);
+        *p++ = ',';
+        p = outText(p, currentBook->ISBN);
+        *p++ = ',';
+        p = outInt(p, currentBook->exampleCount);
+        *p++ = '\n';
+        out.size = (size_t)(p - out.data);
+        if (out.size >= OUT_FLUSH_SIZE && outFlush(&out, file) != 0) {
+            failed = 1;
+        }
+    }
+    if (!failed && outFlush(&out, file) != 0) {
+        failed = 1;
+    }
+    outFree(&out);
+    if (failed) {
+        abandonRewrite(file, "kitaplar.csv");
+        return -1;
+    }
+    return finishRewrite(file, "kitaplar.csv");
+}
+
+
+// Add a new book
+void addBook(Book **bookHead) {
+    char bookName[MAX_NAME_LEN];
+    char ISBN[MAX_ISBN_LEN];
+
+    printf("Enter Book Name: ");
+    fgets(bookName, sizeof(bookName), stdin);
+    bookName[strcspn(bookName, "\n")] = 0; 
+
+    printf("Enter ISBN: ");
+    fgets(ISBN, sizeof(ISBN), stdin);
+    ISBN[strcspn(ISBN, "\n")] = 0; 
+
+    Book *existing = findBookByISBN(*bookHead, ISBN);
+    if (existing) {
+        printf("A book with ISBN '%s' already exists (ID %d).\n", ISBN, existing->bookId);
+        return;
+    }
+
+    int exampleCount;
+    printf("Enter Number of Examples: ");
+    scanf("%d", &exampleCount);
+    getchar(); 
+
+    Book *newBook;
+    int status = insertBook(bookHead, 0, bookName, ISBN, exampleCount, &newBook);
+    if (status == OP_OK) {
+        printf("Book added successfully with ID %d.\n", newBook->bookId);
+    } else if (status == OP_BAD_REQUEST) {
+        printf("An ISBN cannot contain commas.\n");
+    }
+}
+
+// Create a book and append it to the list and indexes. bookId 0 takes the
+// next ID from the sequence. Returns OP_OK (the book in *result if result
+// is not NULL), OP_DUPLICATE if the ID or the ISBN is taken, OP_BAD_REQUEST
+// if the ISBN cannot be stored (see isbnStorable), or OP_NO_MEMORY.
+int insertBook(Book **bookHead, int bookId, const char *bookName, const char *ISBN, int exampleCount, Book **result) {
+    if (!isbnStorable(ISBN)) {
+        return OP_BAD_REQUEST;
+    }
+    if (findBookByISBN(*bookHead, ISBN) ||
+        (bookId != 0 && hashIndexGet(&bookIdIndex, (uint32_t)bookId))) {
+        return OP_DUPLICATE;
+    }
+
+    Book *newBook = (Book *)poolAlloc(&bookPool);
+    if (!newBook) {
+        perror("Memory allocation failed");
+        return OP_NO_MEMORY;
+    }
+    newBook->next = NULL;
+    snprintf(newBook->bookName, sizeof(newBook->bookName), "%s", bookName);
+    snprintf(newBook->ISBN, sizeof(newBook->ISBN), "%s", ISBN);
+
+    if (createBookExamples(newBook, exampleCount) != 0) {
+        poolFree(&bookPool, newBook);
+        return OP_NO_MEMORY;
+    }
+
+    newBook->bookId = bookId != 0 ? bookId : nextBookId;
+    uint64_t key = isbnKey(newBook->ISBN);
+    if (hashIndexInsert(&bookIdIndex, (uint32_t)newBook->bookId, newBook) < 0 ||
+        (key != 0 && hashIndexInsert(&isbnIndex, key, newBook) < 0)) {
+        perror("Memory allocation failed");
+        if (hashIndexGet(&bookIdIndex, (uint32_t)newBook->bookId) == newBook) {
+            hashIndexRemove(&bookIdIndex, (uint32_t)newBook->bookId);
+        }
+        freeBookExamples(newBook);
+        poolFree(&bookPool, newBook);
+        return OP_NO_MEMORY;
+    }
+    if (newBook->bookId >= nextBookId) {
+        nextBookId = newBook->bookId + 1;
+    }
+    nameIndexInsert(&bookNameIndex, newBook->bookName, newBook);
+    wordIndexAdd(&bookWordIndex, newBook->bookName, newBook->bookId);
+    trigramIndexAdd(&bookTrigramIndex, newBook->bookName, newBook->bookId);
+
+    // Add to the end of the list
+    if (*bookHead == NULL) {
+        *bookHead = newBook;
+    } else {
+        bookTail->next = newBook;
+    }
+    bookTail = newBook;
+
+    journalBookPut(newBook);
+    if (result) {
+        *result = newBook;
+    }
+    return OP_OK;
+}
+
+// Delete a book
+void deleteBook(Book **bookHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    int bookId;
+    printf("Enter Book ID to delete: ");
+    scanf("%d", &bookId);
+    getchar(); 
+
+    int status = removeBook(bookHead, bookAuthorArray, bookAuthorCount, bookId);
+    if (status == OP_NOT_FOUND) {
+        printf("Book with ID %d not found.\n", bookId);
+    } else if (status == OP_IN_USE) {
+        printf("Cannot delete book. Some examples are currently borrowed.\n");
+    } else {
+        printf("Book with ID %d deleted successfully.\n", bookId);
+    }
+}
+
+// Delete a book and its book-author links.
+// Returns OP_OK, OP_NOT_FOUND or OP_IN_USE if examples are borrowed.
+int removeBook(Book **bookHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int bookId) {
+    DeleteBatch batch = { 0 };
+    int status = deleteBatchAdd(&batch, TABLE_BOOKS, bookId);
+    if (status == OP_OK) {
+        deleteBatchRun(&batch, bookHead, NULL, NULL, bookAuthorArray, bookAuthorCount);
+    }
+    deleteBatchFree(&batch);
+    return status;
+}
+
+// Update book information
+void updateBook(Book *bookHead) {
+    int bookId;
+    printf("Enter Book ID to update: ");
+    scanf("%d", &bookId);
+    getchar(); 
+
+    Book *book = findBookById(bookHead, bookId);
+    if (!book) {
+        printf("Book with ID %d not found.\n", bookId);
+        return;
+    }
+
+    printf("Enter new Book Name (leave blank to keep current '%s'): ", book->bookName);
+    char newBookName[MAX_NAME_LEN];
+    fgets(newBookName, sizeof(newBookName), stdin);
+    newBookName[strcspn(newBookName, "\n")] = 0; 
+
+    printf("Enter new ISBN (leave blank to keep current '%s'): ", book->ISBN);
+    char newISBN[MAX_ISBN_LEN];
+    fgets(newISBN, sizeof(newISBN), stdin);
+    newISBN[strcspn(newISBN, "\n")] = 0; 
+    if (strlen(newISBN) > 0) {
+        Book *existing = findBookByISBN(bookHead, newISBN);
+        if (existing && existing != book) {
+            printf("A book with ISBN '%s' already exists (ID %d).\n", newISBN, existing->bookId);
+            return;
+        }
+    }
+
+    if (setBookDetails(bookHead, bookId, newBookName, newISBN) == OP_BAD_REQUEST) {
+        printf("An ISBN cannot contain commas.\n");
+        return;
+    }
+    printf("Book with ID %d updated successfully.\n", bookId);
+}
+
+// Change the name and/or ISBN of a book; an empty string keeps the current
+// value. Returns OP_OK, OP_NOT_FOUND, OP_BAD_REQUEST if the ISBN cannot be
+// stored, OP_DUPLICATE if it is taken by another book or OP_NO_MEMORY
+// (nothing is changed then).
+int setBookDetails(Book *bookHead, int bookId, const char *bookName, const char *ISBN) {
+    Book *book = findBookById(bookHead, bookId);
+    if (!book) {
+        return OP_NOT_FOUND;
+    }
+    if (!isbnStorable(ISBN)) {
+        return OP_BAD_REQUEST;
+    }
+    if (ISBN[0] != '\0') {
+        Book *existing = findBookByISBN(bookHead, ISBN);
+        if (existing && existing != book) {
+            return OP_DUPLICATE;
+        }
+        // Index the new ISBN first, so that nothing changes if that fails
+        uint64_t oldKey = isbnKey(book->ISBN);
+        uint64_t newKey = isbnKey(ISBN);
+        if (newKey != oldKey) {
+            if (newKey != 0 && hashIndexInsert(&isbnIndex, newKey, book) < 0) {
+                perror("Memory allocation failed");
+                return OP_NO_MEMORY;
+            }
+            if (oldKey != 0 && hashIndexGet(&isbnIndex, oldKey) == book) {
+                hashIndexRemove(&isbnIndex, oldKey);
+            }
+        }
+    }
+
+    if (bookName[0] != '\0') {
+        nameIndexRemove(&bookNameIndex, book->bookName, book);
+        wordIndexRemove(&bookWordIndex, book->bookName, book->bookId);
+        trigramIndexRemove(&bookTrigramIndex, book->bookName, book->bookId);
+        snprintf(book->bookName, sizeof(book->bookName), "%s", bookName);
+        nameIndexInsert(&bookNameIndex, book->bookName, book);
+        wordIndexAdd(&bookWordIndex, book->bookName, book->bookId);
+        trigramIndexAdd(&bookTrigramIndex, book->bookName, book->bookId);
+    }
+    if (ISBN[0] != '\0') {
+        snprintf(book->ISBN, sizeof(book->ISBN), "%s", ISBN);
+    }
+
+    journalBookPut(book);
+    return OP_OK;
+}
+
+// Print all books
+void printBooks(Book *bookHead) {
+    if (!bookHead) {
+        printf("No books in the library.\n");
+        return;
+    }
+    printf("\n--- Books ---\n");
+    printf("ID | Book Name%*s | ISBN%*s | Example Count\n", MAX_NAME_LEN - 10, "", MAX_ISBN_LEN - 4, "");
+    printf("---|-----------%*s|------%*s|---------------\n", MAX_NAME_LEN - 10, "", MAX_ISBN_LEN - 4, "");
+    Book *temp = bookHead;
+    while (temp != NULL) {
+        printf("%-2d | %-*s | %-*s | %d\n",
+               temp->bookId, MAX_NAME_LEN - 1, temp->bookName, MAX_ISBN_LEN - 1, temp->ISBN, temp->exampleCount);
+        temp = temp->next;
+    }
+    printf("-------------\n");
+}
+
+// Find a book by ID
+Book *findBookById(Book *bookHead, int bookId) {
+    if (!bookHead) {
+        return NULL; // Empty list
+    }
+    return (Book *)hashIndexGet(&bookIdIndex, (uint32_t)bookId);
+}
+
+// Normalize an ISBN into a packed 13-digit integer key. Hyphens and spaces
+// are ignored and ISBN-10 input is converted to its 978-prefixed ISBN-13
+// form, so every spelling of the same book maps to the same key. Check
+// digits are not validated. Any other code is keyed by a hash of its exact
+// text with the top bit set, which packed keys (below 10^13) never have.
+// Returns 0 for an empty ISBN, which means the book has none.
+uint64_t isbnKey(const char *ISBN) {
+    int digits[13];
+    int count = 0;
+    for (const char *p = ISBN; *p; p++) {
+        if (*p == '-' || *p == ' ') {
+            continue;
+        }
+        if (count < 13 && *p >= '0' && *p <= '9') {
+            digits[count++] = *p - '0';
+        } else if (count == 9 && (*p == 'X' || *p == 'x') && p[1] == '\0') {
+            digits[count++] = 10; // ISBN-10 check digit
+        } else {
+            count = -1; // Not an ISBN
+            break;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t key = 0;
+    if (count == 13) {
+        for (int i = 0; i < 13; i++) {
+            key = key * 10 + digits[i];
+        }
+        return key;
+    }
+    if (count == 10) {
+        // 978 + first nine digits + recomputed ISBN-13 check digit
+        int sum = 9 + 7 * 3 + 8;
+        key = 978;
+        for (int i = 0; i < 9; i++) {
+            key = key * 10 + digits[i];
+            sum += digits[i] * ((i % 2 == 0) ? 3 : 1);
+        }
+        return key * 10 + (10 - sum % 10) % 10;
+    }
+
+    // FNV-1a, as for the word index
+    key = 0xcbf29ce484222325ULL;
+    for (const unsigned char *p = (const unsigned char *)ISBN; *p; p++) {
+        key ^= *p;
+        key *= 0x100000001b3ULL;
+    }
+    return key | 1ULL << 63;
+}
+
+// 1 if ISBN can be stored: kitaplar.csv splits the ISBN off the end of
+// the row at a comma, so it may not contain commas or line breaks
+int isbnStorable(const char *ISBN) {
+    return strpbrk(ISBN, ",\r\n") == NULL;
+}
+
+// Find a book by ISBN with one hash probe. An empty ISBN finds nothing.
+Book *findBookByISBN(Book *bookHead, const char *ISBN) {
+    if (!bookHead) {
+        return NULL; // Empty list
+    }
+    uint64_t key = isbnKey(ISBN);
+    if (key == 0) {
+        return NULL;
+    }
+    Book *book = (Book *)hashIndexGet(&isbnIndex, key);
+    if (book && (key >> 63) && strcmp(book->ISBN, ISBN) != 0) {
+        return NULL; // Another free-form code with the same hash
+    }
+    return book;
+}
+
+// Find a book by name
+Book *findBookByName(Book *bookHead, const char *bookName) {
+    if (!bookHead) {
+        return NULL; // Empty list
+    }
+    return (Book *)nameIndexFindExact(&bookNameIndex, bookName, offsetof(Book, bookName));
+}
+
+// Print a book found by exact name, or else every book whose name starts
+// with the given text, ignoring case
+void searchBooksByName(Book *bookHead, const char *bookName) {
+    Book *foundBook = findBookByName(bookHead, bookName);
+    if (foundBook) {
+        printf("Book Found: ID %d, Name: %s, ISBN: %s\n", foundBook->bookId, foundBook->bookName, foundBook->ISBN);
+        return;
+    }
+
+    Book *matches[MAX_SEARCH_RESULTS];
+    size_t total = findBooksByNamePrefix(bookName, matches, MAX_SEARCH_RESULTS);
+    if (total == 0) {
+        printf("Book '%s' not found.\n", bookName);
+        int ids[MAX_SUGGESTIONS];
+        size_t similar = findBooksBySimilarName(bookName, ids, MAX_SUGGESTIONS);
+        if (similar > 0) {
+            printf("Did you mean:\n");
+        }
+        for (size_t i = 0; i < similar && i < MAX_SUGGESTIONS; i++) {
+            Book *book = (Book *)hashIndexGet(&bookIdIndex, (uint32_t)ids[i]);
+            printf("  ID %d, Name: %s, ISBN: %s\n", book->bookId, book->bookName, book->ISBN);
+        }
+        return;
+    }
+    printf("Books starting with '%s':\n", bookName);
+    for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS; i++) {
+        printf("  ID %d, Name: %s, ISBN: %s\n", matches[i]->bookId, matches[i]->bookName, matches[i]->ISBN);
+    }
+    if (total > MAX_SEARCH_RESULTS) {
+        printf("  ... and %zu more\n", total - MAX_SEARCH_RESULTS);
+    }
+}
+
+// Print the books having every word of the query in the title or in an
+// author's name, best matches first
+void searchBooksByWords(Book *bookHead, Author *authorHead, const BookAuthor *bookAuthorArray, int bookAuthorCount,
+                        const char *query) {
+    int ids[MAX_SEARCH_RESULTS];
+    size_t total = findBooksByWords(query, bookHead, authorHead, bookAuthorArray, bookAuthorCount,
+                                    ids, MAX_SEARCH_RESULTS);
+    if (total == 0) {
+        printf("No book matches '%s'.\n", query);
+        return;
+    }
+    printf("Books matching '%s':\n", query);
+    for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS; i++) {
+        Book *book = (Book *)hashIndexGet(&bookIdIndex, (uint32_t)ids[i]);
+        if (book) {
+            printf("  ID %d, Name: %s, ISBN: %s\n", book->bookId, book->bookName, book->ISBN);
+        }
+    }
+    if (total > MAX_SEARCH_RESULTS) {
+        printf("  ... and %zu more\n", total - MAX_SEARCH_RESULTS);
+    }
+}
+
+
+// Bitmap words of a book's examples
+static uint64_t *bookExampleWords(Book *book) {
+    return book->exampleCount <= 64 ? &book->examples.inlineBits : book->examples.bits;
+}
+
+// Create the examples of a book, all on the shelf (called during book
+// loading/adding). Returns 0 on success, -1 on allocation failure.
+int createBookExamples(Book *book, int exampleCount) {
+    if (exampleCount < 0) {
+        exampleCount = 0;
+    }
+    book->exampleCount = exampleCount;
+    book->availableCount = exampleCount;
+    if (exampleCount <= 64) {
+        book->examples.inlineBits = 0;
+        return 0;
+    }
+
+    book->examples.bits = (uint64_t *)calloc((exampleCount + 63) / 64, sizeof(uint64_t));
+    if (!book->examples.bits) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+    wideBookCount++;
+    return 0;
+}
+
+// Free the out-of-line bitmap of a book, if it has one
+void freeBookExamples(Book *book) {
+    if (book->exampleCount > 64) {
+        free(book->examples.bits);
+        wideBookCount--;
+    }
+    book->exampleCount = 0;
+    book->availableCount = 0;
+}
+
+// Status of one example: 0: On Shelf, 1: Borrowed, -1: no such example
+int getBookExampleStatus(const Book *book, int exampleId) {
+    if (exampleId < 1 || exampleId > book->exampleCount) {
+        return -1;
+    }
+    uint64_t *words = bookExampleWords((Book *)book);
+    int bit = exampleId - 1;
+    return (int)((__atomic_load_n(&words[bit / 64], __ATOMIC_ACQUIRE) >> (bit % 64)) & 1);
+}
+
+// Claim an example for a loan by setting its bit atomically, so however
+// many threads borrow at once an example is lent only once. exampleId 0
+// claims the lowest-numbered example on the shelf. Returns the claimed
+// example ID, or 0 if the example does not exist or is already borrowed
+// (for 0: if every example is borrowed).
+int claimBookExample(Book *book, int exampleId) {
+    if (exampleId < 0 || exampleId > book->exampleCount) {
+        return 0;
+    }
+    uint64_t *words = bookExampleWords(book);
+    if (exampleId != 0) {
+        // A single bit needs no retry loop: fetch-or tells whether it was already set
+        int bit = exampleId - 1;
+        uint64_t mask = 1ULL << (bit % 64);
+        if (__atomic_fetch_or(&words[bit / 64], mask, __ATOMIC_ACQ_REL) & mask) {
+            return 0;
+        }
+        __atomic_fetch_sub(&book->availableCount, 1, __ATOMIC_RELAXED);
+        return exampleId;
+    }
+
+    if (__atomic_load_n(&book->availableCount, __ATOMIC_RELAXED) == 0) {
+        return 0;
+    }
+    int wordCount = (book->exampleCount + 63) / 64;
+    for (int w = 0; w < wordCount; w++) {
+        uint64_t valid = ~0ULL;
+        if (w == wordCount - 1 && book->exampleCount % 64 != 0) {
+            valid = (1ULL << (book->exampleCount % 64)) - 1; // Ignore bits past the last example
+        }
+        // Take the lowest clear bit with a compare-and-swap; when another
+        // thread changed the word in between, retry with its new value
+        uint64_t word = __atomic_load_n(&words[w], __ATOMIC_ACQUIRE);
+        uint64_t freeBits;
+        while ((freeBits = ~word & valid) != 0) {
+            uint64_t mask = freeBits & -freeBits;
+            if (__atomic_compare_exchange_n(&words[w], &word, word | mask, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                __atomic_fetch_sub(&book->availableCount, 1, __ATOMIC_RELAXED);
+                return w * 64 + __builtin_ctzll(mask) + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Put a claimed example back on the shelf. Returns 0, or -1 if the example
+// does not exist or was not borrowed.
+int releaseBookExample(Book *book, int exampleId) {
+    if (exampleId < 1 || exampleId > book->exampleCount) {
+        return -1;
+    }
+    int bit = exampleId - 1;
+    uint64_t mask = 1ULL << (bit % 64);
+    if (!(__atomic_fetch_and(&bookExampleWords(book)[bit / 64], ~mask, __ATOMIC_ACQ_REL) & mask)) {
+        return -1;
+    }
+    __atomic_fetch_add(&book->availableCount, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// Print all book examples for all books
+void printBookExamples(Book *bookHead) {
+    if (!bookHead) {
+        printf("No books in the library to show examples.\n");
+        return;
+    }
+    printf("\n--- Book Examples ---\n");
+    Book *tmp = bookHead;
+    while (tmp != NULL) {
+        printf("Book: %s (ID: %d)\n", tmp->bookName, tmp->bookId);
+        printf("  Example ID | Status (0: Shelf, 1: Borrowed)\n");
+        printf("  -----------|-------------------------------\n");
+        for (int exampleId = 1; exampleId <= tmp->exampleCount; exampleId++) {
+            printf("  %-10d | %d\n", exampleId, getBookExampleStatus(tmp, exampleId));
+        }
+        printf("----------------------------------------\n");
+        tmp = tmp->next;
+    }
+}
+
+// Print book examples for a specific book by name
+void printBookExamplesByBookName(Book *bookHead) {
+    char bookName[MAX_NAME_LEN];
+    printf("Enter Book Name to show examples: ");
+    fgets(bookName, sizeof(bookName), stdin);
+    bookName[strcspn(bookName, "\n")] = 0; 
+
+    Book *book = findBookByName(bookHead, bookName);
+    if (!book) {
+        printf("Book '%s' not found.\n", bookName);
+        return;
+    }
+
+    printf("\n--- Book Examples for '%s' ---\n", book->bookName);
+    printf("  Example ID | Status (0: Shelf, 1: Borrowed)\n");
+    printf("  -----------|-------------------------------\n");
+    if (book->exampleCount == 0) {
+        printf("  No examples available for this book.\n");
+    } else {
+        for (int exampleId = 1; exampleId <= book->exampleCount; exampleId++) {
+            printf("  %-10d | %d\n", exampleId, getBookExampleStatus(book, exampleId));
+        }
+        printf("  %d of %d examples on the shelf.\n", book->availableCount, book->exampleCount);
+    }
+    printf("----------------------------------------\n");
+}
+
+
+// --- Author Functions ---
+
+// Add an author read by a loader to the end of the list and to the indexes.
+// Returns 0 on success, 1 if the author ID is taken (the node is not linked).
+int linkLoadedAuthor(Author *newAuthor, Author **authorHead, Author **last) {
+    if (hashIndexInsert(&authorIdIndex, (uint32_t)newAuthor->authorId, newAuthor) == 1) {
+        return 1;
+    }
+    nameIndexAppend(&authorNameIndex, newAuthor->authorName, newAuthor);
+
+    if (newAuthor->authorId >= nextAuthorId) {
+        nextAuthorId = newAuthor->authorId + 1;
+    }
+
+    newAuthor->next = NULL;
+    if (*authorHead == NULL) {
+        *authorHead = newAuthor;
+    } else {
+        (*last)->next = newAuthor;
+    }
+    *last = newAuthor;
+    return 0;
+}
+
+// Load authors from CSV
+void loadAuthors(Author **authorHead) {
+    CsvReader reader;
+    if (csvOpen(&reader, "yazarlar.csv") != 0) {
+        *authorHead = NULL;
+        return;
+    }
+
+    Author *last = NULL;
+
+    
+    csvNextRecord(&reader, 1);
+
+    // CSV line: authorId,authorName (the name may contain commas)
+    while (csvNextRecord(&reader, 2)) {
+        int authorId;
+        if (reader.fieldCount != 2) {
+            csvReportMalformed(&reader, "expected 2 fields");
+            continue;
+        }
+        if (csvParseInt(reader.fields[0], reader.lengths[0], &authorId) != 0) {
+            csvReportMalformed(&reader, "invalid author ID");
+            continue;
+        }
+        if (reader.lengths[1] >= MAX_NAME_LEN) {
+            csvReportMalformed(&reader, "author name too long");
+            continue;
+        }
+
+        Author *newAuthor = (Author *)poolAlloc(&authorPool);
+        if (!newAuthor) {
+            perror("Memory allocation failed");
+            break; 
+        }
+        newAuthor->next = NULL;
+        newAuthor->authorId = authorId;
+        csvCopyField(reader.fields[1], reader.lengths[1], newAuthor->authorName, sizeof(newAuthor->authorName));
+        if (linkLoadedAuthor(newAuthor, authorHead, &last) != 0) {
+            csvReportMalformed(&reader, "duplicate author ID");
+            poolFree(&authorPool, newAuthor);
+            continue;
+        }
+    }
+    authorTail = last;
+    nameIndexSort(&authorNameIndex);
+    if (reader.malformed > 0) {
+        __atomic_fetch_or(&csvSkippedTables, TABLE_AUTHORS, __ATOMIC_RELAXED);
+    }
+    csvClose(&reader);
+}
+
+// Save authors to CSV. Returns 0 on success, -1 on error.
+int saveAuthors(Author *authorHead) {
+    FILE *file = openForRewrite("yazarlar.csv");
+    if (!file) {
+        return -1;
+    }
+
+    OutBuffer out = { NULL, 0, 0 };
+    int failed = outReserve(&out, OUT_ROW_MAX) != 0;
+
+    // Write header
+    if (!failed) {
+        out.size = (size_t)(outText(out.data, "authorId,authorName\n") - out.data);
+    }
+
+    for (Author *current = authorHead; current != NULL && !failed; current = current->next) {
+        if (outReserve(&out, OUT_ROW_MAX) != 0) {
+            failed = 1;
+            break;
+        }
+        char *p = out.data + out.size;
+        p = outInt(p, current->authorId);
+        *p++ = ',';
+        p = outText(p, current->authorName);
+        *p++ = '\n';
+        out.size = (size_t)(p - out.data);
+        if (out.size >= OUT_FLUSH_SIZE && outFlush(&out, file) != 0) {
+            failed = 1;
+        }
+    }
+    if (!failed && outFlush(&out, file) != 0) {
+        failed = 1;
+    }
+    outFree(&out);
+    if (failed) {
+        abandonRewrite(file, "yazarlar.csv");
+        return -1;
+    }
+    return finishRewrite(file, "yazarlar.csv");
+}
+
+// Add a new author
+void addAuthor(Author **authorHead) {
+    char authorName[MAX_NAME_LEN];
+    printf("Enter Author Name: ");
+    fgets(authorName, sizeof(authorName), stdin);
+    authorName[strcspn(authorName, "\n")] = 0; 
+
+    Author *newAuthor;
+    if (insertAuthor(authorHead, 0, authorName, &newAuthor) == OP_OK) {
+        printf("Author added successfully with ID %d.\n", newAuthor->authorId);
+    }
+}
+
+// Create an author and append it to the list and indexes. authorId 0 takes
+// the next ID from the sequence. Returns OP_OK (the author in *result if
+// result is not NULL), OP_DUPLICATE if the ID is taken, or OP_NO_MEMORY.
+int insertAuthor(Author **authorHead, int authorId, const char *authorName, Author **result) {
+    if (authorId != 0 && hashIndexGet(&authorIdIndex, (uint32_t)authorId)) {
+        return OP_DUPLICATE;
+    }
+
+    Author *newAuthor = (Author *)poolAlloc(&authorPool);
+    if (!newAuthor) {
+        perror("Memory allocation failed");
+        return OP_NO_MEMORY;
+    }
+    newAuthor->next = NULL;
+
+    newAuthor->authorId = authorId != 0 ? authorId : nextAuthorId;
+    if (hashIndexInsert(&authorIdIndex, (uint32_t)newAuthor->authorId, newAuthor) < 0) {
+        perror("Memory allocation failed");
+        poolFree(&authorPool, newAuthor);
+        return OP_NO_MEMORY;
+    }
+    if (newAuthor->authorId >= nextAuthorId) {
+        nextAuthorId = newAuthor->authorId + 1;
+    }
+
+    snprintf(newAuthor->authorName, sizeof(newAuthor->authorName), "%s", authorName);
+    nameIndexInsert(&authorNameIndex, newAuthor->authorName, newAuthor);
+    wordIndexAdd(&authorWordIndex, newAuthor->authorName, newAuthor->authorId);
+    trigramIndexAdd(&authorTrigramIndex, newAuthor->authorName, newAuthor->authorId);
+
+    // Add to the end of the list
+    if (*authorHead == NULL) {
+        *authorHead = newAuthor;
+    } else {
+        authorTail->next = newAuthor;
+    }
+    authorTail = newAuthor;
+
+    journalAuthorPut(newAuthor);
+    if (result) {
+        *result = newAuthor;
+    }
+    return OP_OK;
+}
+
+// Delete an author
+void deleteAuthor(Author **authorHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int deletedAuthorId) {
+    if (removeAuthor(authorHead, bookAuthorArray, bookAuthorCount, deletedAuthorId) == OP_NOT_FOUND) {
+        printf("Author with ID %d not found.\n", deletedAuthorId);
+        return;
+    }
+
+    printf("Author with ID %d deleted successfully.\n", deletedAuthorId);
+}
+
+// Delete an author and its book-author links.
+// Returns OP_OK or OP_NOT_FOUND.
+int removeAuthor(Author **authorHead, BookAuthor **bookAuthorArray, int *bookAuthorCount, int authorId) {
+    DeleteBatch batch = { 0 };
+    int status = deleteBatchAdd(&batch, TABLE_AUTHORS, authorId);
+    if (status == OP_OK) {
+        deleteBatchRun(&batch, NULL, authorHead, NULL, bookAuthorArray, bookAuthorCount);
+    }
+    deleteBatchFree(&batch);
+    return status;
+}
+
+
+// Update author information
+void updateAuthor(Author *authorHead) {
+    int authorId;
+    printf("Enter Author ID to update: ");
+    scanf("%d", &authorId);
+    getchar(); 
+
+    Author *author = findAuthorById(authorHead, authorId);
+    if (!author) {
+        printf("Author with ID %d not found.\n", authorId);
+        return;
+    }
+
+    printf("Enter new Author Name (leave blank to keep current '%s'): ", author->authorName);
+    char newAuthorName[MAX_NAME_LEN];
+    fgets(newAuthorName, sizeof(newAuthorName), stdin);
+    newAuthorName[strcspn(newAuthorName, "\n")] = 0; 
+    if (strlen(newAuthorName) > 0) {
+        setAuthorName(authorHead, authorId, newAuthorName);
+    }
+
+    printf("Author with ID %d updated successfully.\n", authorId);
+}
+
+// Rename an author. Returns OP_OK or OP_NOT_FOUND.
+int setAuthorName(Author *authorHead, int authorId, const char *authorName) {
+    Author *author = findAuthorById(authorHead, authorId);
+    if (!author) {
+        return OP_NOT_FOUND;
+    }
+    nameIndexRemove(&authorNameIndex, author->authorName, author);
+    wordIndexRemove(&authorWordIndex, author->authorName, author->authorId);
+    trigramIndexRemove(&authorTrigramIndex, author->authorName, author->authorId);
+    snprintf(author->authorName, sizeof(author->authorName), "%s", authorName);
+    nameIndexInsert(&authorNameIndex, author->authorName, author);
+    wordIndexAdd(&authorWordIndex, author->authorName, author->authorId);
+    trigramIndexAdd(&authorTrigramIndex, author->authorName, author->authorId);
+
+    journalAuthorPut(author);
+    return OP_OK;
+}
+
+// Print all authors
+void printAuthors(Author *authorHead) {
+    if (!authorHead) {
+        printf("No authors in the system.\n");
+        return;
+    }
+    printf("\n--- Authors ---\n");
+    printf("ID | Author Name\n");
+    printf("---|------------\n");
+    Author *temp = authorHead;
+    while (temp != NULL) {
+        printf("%-2d | %s\n", temp->authorId, temp->authorName);
+        temp = temp->next;
+    }
+    printf("---------------\n");
+}
+
+// Find an author by ID
+Author *findAuthorById(Author *authorHead, int authorId) {
+    if (!authorHead) {
+        return NULL; // Empty list
+    }
+    return (Author *)hashIndexGet(&authorIdIndex, (uint32_t)authorId);
+}
+
+// Find an author by name
+Author *findAuthorByName(Author *authorHead, const char *authorName) {
+    if (!authorHead) {
+        return NULL; // Empty list
+    }
+    return (Author *)nameIndexFindExact(&authorNameIndex, authorName, offsetof(Author, authorName));
+}
+
+// Print an author found by exact name, or else every author whose name
+// starts with the given text, ignoring case
+void searchAuthorsByName(Author *authorHead, const char *authorName) {
+    Author *foundAuthor = findAuthorByName(authorHead, authorName);
+    if (foundAuthor) {
+        printf("Author Found: ID %d, Name: %s\n", foundAuthor->authorId, foundAuthor->authorName);
+        return;
+    }
+
+    Author *matches[MAX_SEARCH_RESULTS];
+    size_t total = findAuthorsByNamePrefix(authorName, matches, MAX_SEARCH_RESULTS);
+    if (total == 0) {
+        printf("Author '%s' not found.\n", authorName);
+        int ids[MAX_SUGGESTIONS];
+        size_t similar = findAuthorsBySimilarName(authorName, ids, MAX_SUGGESTIONS);
+        if (similar > 0) {
+            printf("Did you mean:\n");
+        }
+        for (size_t i = 0; i < similar && i < MAX_SUGGESTIONS; i++) {
+            Author *author = (Author *)hashIndexGet(&authorIdIndex, (uint32_t)ids[i]);
+            printf("  ID %d, Name: %s\n", author->authorId, author->authorName);
+        }
+        return;
+    }
+    printf("Authors starting with '%s':\n", authorName);
+    for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS; i++) {
+        printf("  ID %d, Name: %s\n", matches[i]->authorId, matches[i]->authorName);
+    }
+    if (total > MAX_SEARCH_RESULTS) {
+        printf("  ... and %zu more\n", total - MAX_SEARCH_RESULTS);
+    }
+}
+
+// --- Book-Author Link Functions ---
+
+// Load book-author links from CSV
+void loadBookAuthors(BookAuthor **bookAuthorArray, int *count) {
+    *bookAuthorArray = NULL;
+    *count = 0;
+
+    CsvReader reader;
+    if (csvOpen(&reader, "kitap_yazar.csv") != 0) {
+        return;
+    }
+
+    int capacity = 0;
+
+    // Skip header row
+    csvNextRecord(&reader, 1);
+
+    // CSV line: bookId,authorId. Single pass, the array doubles as it fills.
+    while (csvNextRecord(&reader, 2)) {
+        int bookId, authorId;
+        if (reader.fieldCount != 2 ||
+            csvParseInt(reader.fields[0], reader.lengths[0], &bookId) != 0 ||
+            csvParseInt(reader.fields[1], reader.lengths[1], &authorId) != 0) {
+            csvReportMalformed(&reader, "expected bookId,authorId");
+            continue;
+        }
+
+        if (*count == capacity) {
+            int newCapacity = capacity ? capacity * 2 : 64;
+            BookAuthor *grown = (BookAuthor *)realloc(*bookAuthorArray, sizeof(BookAuthor) * newCapacity);
+            if (!grown) {
+                perror("Memory allocation failed");
+                break;
+            }
+            *bookAuthorArray = grown;
+            capacity = newCapacity;
+        }
+        (*bookAuthorArray)[*count].bookId = bookId;
+        (*bookAuthorArray)[*count].authorId = authorId;
+        (*bookAuthorArray)[*count].next = NULL;
+        (*count)++;
+    }
+
+    if (reader.malformed > 0) {
+        __atomic_fetch_or(&csvSkippedTables, TABLE_LINKS, __ATOMIC_RELAXED);
+    }
+    csvClose(&reader);
+    resetBookAuthorIndexes(capacity);
+}
+
+// Save book-author links to CSV. Returns 0 on success, -1 on error.
+int saveBookAuthors(BookAuthor *bookAuthorArray, int count) {
+    FILE *file = openForRewrite("kitap_yazar.csv");
+    if (!file) {
+        return -1;
+    }
+
+    OutBuffer out = { NULL, 0, 0 };
+    int failed = outReserve(&out, OUT_ROW_MAX) != 0;
+
+    // Write header
+    if (!failed) {
+        out.size = (size_t)(outText(out.data, "bookId,authorId\n") - out.data);
+    }
+
+    for (int i = 0; i < count && !failed; i++) {
+        if (outReserve(&out, OUT_ROW_MAX) != 0) {
+            failed = 1;
+            break;
+        }
+        char *p = out.data + out.size;
+        p = outInt(p, bookAuthorArray[i].bookId);
+        *p++ = ',';
+        p = outInt(p, bookAuthorArray[i].authorId);
+        *p++ = '\n';
+        out.size = (size_t)(p - out.data);
+        if (out.size >= OUT_FLUSH_SIZE && outFlush(&out, file) != 0) {
+            failed = 1;
+        }
+    }
+    if (!failed && outFlush(&out, file) != 0) {
+        failed = 1;
+    }
+    outFree(&out);
+    if (failed) {
+        abandonRewrite(file, "kitap_yazar.csv");
+        return -1;
+    }
+    return finishRewrite(file, "kitap_yazar.csv");
+}
+
+
+// Key of a link in linkSet
+static uint64_t linkKey(int bookId, int authorId) {
+    return ((uint64_t)(uint32_t)bookId << 32) | (uint32_t)authorId;
+}
+
+// Fill linkSet from the array. Returns 0 on success, -1 on allocation failure.
+static int buildLinkSet(const BookAuthor *bookAuthorArray, int count) {
+    hashIndexFree(&linkSet);
+    for (int i = 0; i < count; i++) {
+        if (hashIndexInsert(&linkSet, linkKey(bookAuthorArray[i].bookId, bookAuthorArray[i].authorId),
+                            &linkPresent) < 0) {
+            hashIndexFree(&linkSet);
+            return -1;
+        }
+    }
+    linkSetBuilt = 1;
+    return 0;
+}
+
+// Compare two IDs for qsort
+static int compareIds(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Build one direction of the CSR index from the array: rows keyed by
+// book ID (byAuthor 0) or author ID (byAuthor 1). Counts the links per row,
+// turns the counts into offsets and places every link in its row.
+// Returns 0 on success, -1 on allocation failure.
+static int buildLinkIndex(LinkIndex *index, const BookAuthor *bookAuthorArray, int count, int byAuthor) {
+    free(index->rows);
+    free(index->columns);
+    hashIndexFree(&index->rowIndex);
+    index->rowCount = 0;
+    index->rows = (LinkRow *)malloc(sizeof(LinkRow) * (count > 0 ? count : 1));
+    index->columns = (int *)malloc(sizeof(int) * (count > 0 ? count : 1));
+    if (!index->rows || !index->columns) {
+        perror("Memory allocation failed");
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int id = byAuthor ? bookAuthorArray[i].authorId : bookAuthorArray[i].bookId;
+        LinkRow *row = (LinkRow *)hashIndexGet(&index->rowIndex, (uint32_t)id);
+        if (!row) {
+            // rows never grows past count entries, so the pointers stay valid
+            row = &index->rows[index->rowCount++];
+            row->id = id;
+            row->count = 0;
+            if (hashIndexInsert(&index->rowIndex, (uint32_t)id, row) < 0) {
+                return -1;
+            }
+        }
+        row->count++;
+    }
+    int start = 0;
+    for (int r = 0; r < index->rowCount; r++) {
+        index->rows[r].start = start;
+        start += index->rows[r].count;
+        index->rows[r].count = 0;
+    }
+    for (int i = 0; i < count; i++) {
+        int id = byAuthor ? bookAuthorArray[i].authorId : bookAuthorArray[i].bookId;
+        LinkRow *row = (LinkRow *)hashIndexGet(&index->rowIndex, (uint32_t)id);
+        index->columns[row->start + row->count++] = byAuthor ? bookAuthorArray[i].bookId
+                                                             : bookAuthorArray[i].authorId;
+    }
+    for (int r = 0; r < index->rowCount; r++) {
+        if (index->rows[r].count > 1) {
+            qsort(index->columns + index->rows[r].start, index->rows[r].count, sizeof(int), compareIds);
+        }
+    }
+    return 0;
+}
+
+// Release one direction of the CSR index
+static void freeLinkIndex(LinkIndex *index) {
+    free(index->rows);
+    free(index->columns);
+    hashIndexFree(&index->rowIndex);
+    memset(index, 0, sizeof(*index));
+}
+
+// Rebuild the CSR indexes if a change made them stale. Threads holding
+// the links read lock may call this together; the first one rebuilds.
+// Only writers mark them stale, so no reader can be using them meanwhile.
+// Returns 0 on success, -1 on allocation failure.
+static int ensureLinkIndexes(const BookAuthor *bookAuthorArray, int count) {
+    if (__atomic_load_n(&linkIndexesBuilt, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    int status = 0;
+    pthread_mutex_lock(&linkIndexLock);
+    if (!linkIndexesBuilt) {
+        status = buildLinkIndex(&authorsByBook, bookAuthorArray, count, 0);
+        if (status == 0) {
+            status = buildLinkIndex(&booksByAuthor, bookAuthorArray, count, 1);
+        }
+        if (status == 0) {
+            linkIndexedCount = count;
+            __atomic_store_n(&linkIndexesBuilt, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&linkIndexLock);
+    return status;
+}
+
+// Drop the link indexes after the array was loaded or replaced; they are
+// rebuilt from it when next needed. capacity is the array's allocated size.
+void resetBookAuthorIndexes(int capacity) {
+    bookAuthorCapacity = capacity;
+    hashIndexFree(&linkSet);
+    linkSetBuilt = 0;
+    freeLinkIndex(&authorsByBook);
+    freeLinkIndex(&booksByAuthor);
+    linkIndexedCount = 0;
+    __atomic_store_n(&linkIndexesBuilt, 0, __ATOMIC_RELEASE);
+}
+
+// Collect the IDs linked to one book (byAuthor 0) or author (byAuthor 1):
+// its CSR row in ID order, then the links added since the last rebuild.
+// Stores up to maxIds of them in ids and returns how many there are.
+static int collectLinks(const BookAuthor *bookAuthorArray, int count, int id, int byAuthor, int *ids, int maxIds) {
+    if (ensureLinkIndexes(bookAuthorArray, count) != 0) {
+        return 0;
+    }
+    const LinkIndex *index = byAuthor ? &booksByAuthor : &authorsByBook;
+    const LinkRow *row = (const LinkRow *)hashIndexGet(&index->rowIndex, (uint32_t)id);
+    int total = 0;
+    if (row) {
+        total = row->count;
+        int copied = total < maxIds ? total : maxIds;
+        if (copied > 0) {
+            memcpy(ids, index->columns + row->start, sizeof(int) * copied);
+        }
+    }
+    for (int i = linkIndexedCount; i < count; i++) {
+        const BookAuthor *link = &bookAuthorArray[i];
+        if ((byAuthor ? link->authorId : link->bookId) == id) {
+            if (total < maxIds) {
+                ids[total] = byAuthor ? link->bookId : link->authorId;
+            }
+            total++;
+        }
+    }
+    return total;
+}
+
+// Authors of a book. Stores up to maxIds author IDs in authorIds and
+// returns how many there are, in O(authors) once the index is built.
+int getAuthorsOfBook(const BookAuthor *bookAuthorArray, int count, int bookId, int *authorIds, int maxIds) {
+    return collectLinks(bookAuthorArray, count, bookId, 0, authorIds, maxIds);
+}
+
+// Books of an author. Stores up to maxIds book IDs in bookIds and returns
+// how many there are, in O(books) once the index is built.
+int getBooksByAuthor(const BookAuthor *bookAuthorArray, int count, int authorId, int *bookIds, int maxIds) {
+    return collectLinks(bookAuthorArray, count, authorId, 1, bookIds, maxIds);
+}
+
+// Add a new book-author link. Returns OP_OK, OP_DUPLICATE or OP_NO_MEMORY.
+int addBookAuthor(BookAuthor **bookAuthorArray, int *count, int bookId, int authorId) {
+    // Check if the link already exists
+    if (!linkSetBuilt && buildLinkSet(*bookAuthorArray, *count) != 0) {
+        return OP_NO_MEMORY;
+    }
+    uint64_t key = linkKey(bookId, authorId);
+    int inserted = hashIndexInsert(&linkSet, key, &linkPresent);
+    if (inserted == 1) {
+        return OP_DUPLICATE;
+    }
+    if (inserted < 0) {
+        return OP_NO_MEMORY;
+    }
+
+    // Grow the array by doubling, so adds are amortized O(1)
+    if (*count >= bookAuthorCapacity) {
+        int newCapacity = bookAuthorCapacity ? bookAuthorCapacity * 2 : 64;
+        BookAuthor *grown = (BookAuthor *)realloc(*bookAuthorArray, sizeof(BookAuthor) * newCapacity);
+        if (!grown) {
+            perror("Memory re-allocation failed");
+            hashIndexRemove(&linkSet, key);
+            return OP_NO_MEMORY;
+        }
+        *bookAuthorArray = grown;
+        bookAuthorCapacity = newCapacity;
+    }
+
+    // Add the new link
+    (*bookAuthorArray)[*count].bookId = bookId;
+    (*bookAuthorArray)[*count].authorId = authorId;
+    (*bookAuthorArray)[*count].next = NULL;
+    (*count)++;
+    if (*count - linkIndexedCount > LINK_MAX_PENDING) {
+        __atomic_store_n(&linkIndexesBuilt, 0, __ATOMIC_RELEASE);
+    }
+
+    journalLinkAdd(bookId, authorId);
+    return OP_OK;
+}
+
+// Update a book-author link (Less common, usually delete and re-add)
+void updateBookAuthor(BookAuthor *bookAuthorArray, int count) {
+    printf("Updating book-author links is typically done by deleting and re-adding.\n");
+}
+
+// Print all book-author links
+void printBookAuthors(BookAuthor *bookAuthorArray, int count) {
+    if (count == 0) {
+        printf("No book-author links recorded.\n");
+        return;
+    }
+    printf("\n--- Book-Author Links ---\n");
+    printf("Book ID | Author ID\n");
+    printf("--------|----------\n");
+    for (int i = 0; i < count; i++) {
+        printf("%-7d | %d\n", bookAuthorArray[i].bookId, bookAuthorArray[i].authorId);
+    }
+    printf("-------------------------\n");
+}
+
+// Print the authors of a book
+void printAuthorsOfBook(const BookAuthor *bookAuthorArray, int count, int bookId) {
+    int authorCount = getAuthorsOfBook(bookAuthorArray, count, bookId, NULL, 0);
+    if (authorCount == 0) {
+        printf("No authors linked to book %d.\n", bookId);
+        return;
+    }
+    int *authorIds = (int *)malloc(sizeof(int) * authorCount);
+    if (!authorIds) {
+        perror("Memory allocation failed");
+        return;
+    }
+    getAuthorsOfBook(bookAuthorArray, count, bookId, authorIds, authorCount);
+    printf("\n--- Authors of Book %d ---\n", bookId);
+    printf("Author ID | Name\n");
+    printf("----------|-----\n");
+    for (int i = 0; i < authorCount; i++) {
+        Author *author = (Author *)hashIndexGet(&authorIdIndex, (uint32_t)authorIds[i]);
+        printf("%-9d | %s\n", authorIds[i], author ? author->authorName : "(missing)");
+    }
+    printf("-------------------------\n");
+    free(authorIds);
+}
+
+// Print the books of an author
+void printBooksByAuthor(const BookAuthor *bookAuthorArray, int count, int authorId) {
+    int bookCount = getBooksByAuthor(bookAuthorArray, count, authorId, NULL, 0);
+    if (bookCount == 0) {
+        printf("No books linked to author %d.\n", authorId);
+        return;
+    }
+    int *bookIds = (int *)malloc(sizeof(int) * bookCount);
+    if (!bookIds) {
+        perror("Memory allocation failed");
+        return;
+    }
+    getBooksByAuthor(bookAuthorArray, count, authorId, bookIds, bookCount);
+    printf("\n--- Books by Author %d ---\n", authorId);
+    printf("Book ID | Name\n");
+    printf("--------|-----\n");
+    for (int i = 0; i < bookCount; i++) {
+        Book *book = (Book *)hashIndexGet(&bookIdIndex, (uint32_t)bookIds[i]);
+        printf("%-7d | %s\n", bookIds[i], book ? book->bookName : "(missing)");
+    }
+    printf("-------------------------\n");
+    free(bookIds);
+}
+
+
+
+// --- Student Functions ---
+
+// Add a student read by a loader to the end of the list and to the indexes.
+// Returns 0 on success, 1 if the student ID is taken (the node is not linked).
+int linkLoadedStudent(Student *newStudent, Student **studentHead, Student **last) {
+    if (hashIndexInsert(&studentIdIndex, (uint32_t)newStudent->studentId, newStudent) == 1) {
+        return 1;
+    }
+    nameIndexAppend(&studentNameIndex, newStudent->studentName, newStudent);
+    newStudent->prevPenalized = NULL;
+    newStudent->nextPenalized = NULL;
+    if (newStudent->penaltyDays > 0) {
+        penalizedAdd(newStudent);
+    }
+
+    if (newStudent->studentId >= nextStudentId) {
+        nextStudentId = newStudent->studentId + 1;
+    }
+
+    newStudent->next = NULL;
+    if (*studentHead == NULL) {
+        *studentHead = newStudent;
+    } else {
+        (*last)->next = newStudent;
+    }
+    *last = newStudent;
+    return 0;
+}
+
+// Load students from CSV
+void loadStudents(Student **studentHead) {
+    CsvReader reader;
+    if (csvOpen(&reader, "ogrenciler.csv") != 0) {
+        *studentHead = NULL;
+        return;
+    }
+
+    Student *last = NULL;
+
+    
+    csvNextRecord(&reader, 1);
+
+    // CSV line: studentId,studentName,penaltyDays (the name may contain
+    // commas, so penaltyDays is split off from the right)
+    while (csvNextRecord(&reader, 2)) {
+        int studentId, penaltyDays;
+        if (reader.fieldCount != 2 || csvSplitField(&reader, 1) != 0) {
+            csvReportMalformed(&reader, "expected 3 fields");
+            continue;
+        }
+        if (csvParseInt(reader.fields[0], reader.lengths[0], &studentId) != 0) {
+            csvReportMalformed(&reader, "invalid student ID");
+            continue;
+        }
+        if (csvParseInt(reader.fields[2], reader.lengths[2], &penaltyDays) != 0) {
+            csvReportMalformed(&reader, "invalid penalty days");
+            continue;
+        }
+        if (reader.lengths[1] >= MAX_NAME_LEN) {
+            csvReportMalformed(&reader, "student name too long");
+            continue;
+        }
+
+        Student *newStudent = (Student *)poolAlloc(&studentPool);
+        if (!newStudent) {
+            perror("Memory allocation failed");
+            break; 
+        }
+        newStudent->next = NULL;
+        newStudent->studentId = studentId;
+        newStudent->penaltyDays = penaltyDays;
+        csvCopyField(reader.fields[1], reader.lengths[1], newStudent->studentName, sizeof(newStudent->studentName));
+        if (linkLoadedStudent(newStudent, studentHead, &last) != 0) {
+            csvReportMalformed(&reader, "duplicate student ID");
+            poolFree(&studentPool, newStudent);
+            continue;
+        }
+    }
+    studentTail = last;
+    nameIndexSort(&studentNameIndex);
+    if (reader.malformed > 0) {
+        __atomic_fetch_or(&csvSkippedTables, TABLE_STUDENTS, __ATOMIC_RELAXED);
+    }
+    csvClose(&reader);
+}
+
+// Save students to CSV. Returns 0 on success, -1 on error.
+int saveStudents(Student *studentHead) {
+    FILE *file = openForRewrite("ogrenciler.csv");
+    if (!file) {
+        return -1;
+    }
+
+    OutBuffer out = { NULL, 0, 0 };
+    int failed = outReserve(&out, OUT_ROW_MAX) != 0;
+
+    // Write header
+    if (!failed) {
+        out.size = (size_t)(outText(out.data, "studentId,studentName,penaltyDays\n") - out.data);
+    }
+
+    for (Student *current = studentHead; current != NULL && !failed; current = current->next) {
+        if (outReserve(&out, OUT_ROW_MAX) != 0) {
+            failed = 1;
+            break;
+        }
+        char *p = out.data + out.size;
+        p = outInt(p, current->studentId);
+        *p++ = ',';
+        p = outText(p, current->studentName);
+        *p++ = ',';
+        p = outInt(p, current->penaltyDays);
+        *p++ = '\n';
+        out.size = (size_t)(p - out.data);
+        if (out.size >= OUT_FLUSH_SIZE && outFlush(&out, file) != 0) {
+            failed = 1;
+        }
+    }
+    if (!failed && outFlush(&out, file) != 0) {
+        failed = 1;
+    }
+    outFree(&out);
+    if (failed) {
+        abandonRewrite(file, "ogrenciler.csv");
+        return -1;
+    }
+    return finishRewrite(file, "ogrenciler.csv");
+}
+
+// Add a new student
+void addStudent(Student **studentHead) {
+    char studentName[MAX_NAME_LEN];
+    printf("Enter Student Name: ");
+    fgets(studentName, sizeof(studentName), stdin);
+    studentName[strcspn(studentName, "\n")] = 0; 
+
+    Student *newStudent;
+    if (insertStudent(studentHead, 0, studentName, 0, &newStudent) == OP_OK) { // New student starts with 0 penalty days
+        printf("Student added successfully with ID %d.\n", newStudent->studentId);
+    }
+}
+
+// Create a student and append it to the list and indexes. studentId 0
+// takes the next ID from the sequence. Returns OP_OK (the student in
+// *result if result is not NULL), OP_DUPLICATE if the ID is taken, or
+// OP_NO_MEMORY.
+int insertStudent(Student **studentHead, int studentId, const char *studentName, int penaltyDays, Student **result) {
+    if (studentId != 0 && hashIndexGet(&studentIdIndex, (uint32_t)studentId)) {
+        return OP_DUPLICATE;
+    }
+
+    Student *newStudent = (Student *)poolAlloc(&studentPool);
+    if (!newStudent) {
+        perror("Memory allocation failed");
+        return OP_NO_MEMORY;
+    }
+    newStudent->next = NULL;
+
+    newStudent->studentId = studentId != 0 ? studentId : nextStudentId;
+    if (hashIndexInsert(&studentIdIndex, (uint32_t)newStudent->studentId, newStudent) < 0) {
+        perror("Memory allocation failed");
+        poolFree(&studentPool, newStudent);
+        return OP_NO_MEMORY;
+    }
+    if (newStudent->studentId >= nextStudentId) {
+        nextStudentId = newStudent->studentId + 1;
+    }
+
+    snprintf(newStudent->studentName, sizeof(newStudent->studentName), "%s", studentName);
+    newStudent->penaltyDays = 0;
+    newStudent->prevPenalized = NULL;
+    newStudent->nextPenalized = NULL;
+    setStudentPenalty(newStudent, penaltyDays);
+    nameIndexInsert(&studentNameIndex, newStudent->studentName, newStudent);
+    trigramIndexAdd(&studentTrigramIndex, newStudent->studentName, newStudent->studentId);
+
+    // Add to the end of the list
+    if (*studentHead == NULL) {
+        *studentHead = newStudent;
+    } else {
+        studentTail->next = newStudent;
+    }
+    studentTail = newStudent;
+
+    journalStudentPut(newStudent);
+    if (result) {
+        *result = newStudent;
+    }
+    return OP_OK;
+}
+
+// Delete a student by ID
+void deleteStudentById(Student **studentHead) {
+    int studentId;
+    printf("Enter Student ID to delete: ");
+    scanf("%d", &studentId);
+    getchar(); 
+
+    int status = removeStudent(studentHead, studentId);
+    if (status == OP_IN_USE) {
+        printf("Cannot delete student with active book loans.\n");
+    } else if (status == OP_NOT_FOUND) {
+        printf("Student with ID %d not found.\n", studentId);
+    } else {
+        printf("Student with ID %d deleted successfully.\n", studentId);
+    }
+}
+
+// Delete a student.
+// Returns OP_OK, OP_NOT_FOUND or OP_IN_USE if the student has active loans.
+int removeStudent(Student **studentHead, int studentId) {
+    DeleteBatch batch = { 0 };
+    int status = deleteBatchAdd(&batch, TABLE_STUDENTS, studentId);
+    if (status == OP_OK) {
+        deleteBatchRun(&batch, NULL, NULL, studentHead, NULL, NULL);
+    }
+    deleteBatchFree(&batch);
+    return status;
+}
+
+// Delete a student by Name
+void deleteStudentByName(Student **studentHead) {
+    char studentName[MAX_NAME_LEN];
+    printf("Enter Student Name to delete: ");
+    fgets(studentName, sizeof(studentName), stdin);
+    studentName[strcspn(studentName, "\n")] = 0; 
+
+    Student *current = findStudentByName(*studentHead, studentName);
+    if (!current) {
+        printf("Student with name '%s' not found.\n", studentName);
+        return;
+    }
+
+    if (removeStudent(studentHead, current->studentId) == OP_IN_USE) {
+        printf("Cannot delete student with active book loans.\n");
+        return;
+    }
+
+    printf("Student with name '%s' deleted successfully.\n", studentName);
+}
+
+
+// Update student information
+void updateStudent(Student *studentHead) {
+    int studentId;
+    printf("Enter Student ID to update: ");
+    scanf("%d", &studentId);
+    getchar(); 
+
+    Student *student = findStudentById(studentHead, studentId);
+    if (!student) {
+        printf("Student with ID %d not found.\n", studentId);
+        return;
+    }
+
+    printf("Enter new Student Name (leave blank to keep current '%s'): ", student->studentName);
+    char newStudentName[MAX_NAME_LEN];
+    fgets(newStudentName, sizeof(newStudentName), stdin);
+    newStudentName[strcspn(newStudentName, "\n")] = 0; 
+    if (strlen(newStudentName) > 0) {
+        setStudentName(studentHead, studentId, newStudentName);
+    }
+
+    printf("Student with ID %d updated successfully.\n", studentId);
+}
+
+// Rename a student. Returns OP_OK or OP_NOT_FOUND.
+int setStudentName(Student *studentHead, int studentId, const char *studentName) {
+    Student *student = findStudentById(studentHead, studentId);
+    if (!student) {
+        return OP_NOT_FOUND;
+    }
+    nameIndexRemove(&studentNameIndex, student->studentName, student);
+    trigramIndexRemove(&studentTrigramIndex, student->studentName, student->studentId);
+    snprintf(student->studentName, sizeof(student->studentName), "%s", studentName);
+    nameIndexInsert(&studentNameIndex, student->studentName, student);
+    trigramIndexAdd(&studentTrigramIndex, student->studentName, student->studentId);
+
+    journalStudentPut(student);
+    return OP_OK;
+}
+
+// Print all students
+void printStudents(Student *studentHead) {
+    if (!studentHead) {
+        printf("No students in the system.\n");
+        return;
+    }
+    printf("\n--- Students ---\n");
+    printf("ID | Student Name%*s | Penalty Days\n", MAX_NAME_LEN - 12, "");
+    printf("---|-------------%*s|--------------\n", MAX_NAME_LEN - 12, "");
+    Student *temp = studentHead;
+    while (temp != NULL) {
+        printf("%-2d | %-*s | %d\n", temp->studentId, MAX_NAME_LEN - 1, temp->studentName, temp->penaltyDays);
+        temp = temp->next;
+    }
+    printf("----------------\n");
+}
+
+// Find a student by ID
+Student *findStudentById(Student *studentHead, int studentId) {
+    if (!studentHead) {
+        return NULL; // Empty list
+    }
+    return (Student *)hashIndexGet(&studentIdIndex, (uint32_t)studentId);
+}
+
+// Find a student by name
+Student *findStudentByName(Student *studentHead, const char *studentName) {
+    if (!studentHead) {
+        return NULL; // Empty list
+    }
+    return (Student *)nameIndexFindExact(&studentNameIndex, studentName, offsetof(Student, studentName));
+}
+
+// Print a student found by exact name, or else every student whose name
+// starts with the given text, ignoring case
+void searchStudentsByName(Student *studentHead, const char *studentName) {
+    Student *foundStudent = findStudentByName(studentHead, studentName);
+    if (foundStudent) {
+        printf("Student Found: ID %d, Name: %s, Penalty Days: %d\n", foundStudent->studentId, foundStudent->studentName, foundStudent->penaltyDays);
+        return;
+    }
+
+    Student *matches[MAX_SEARCH_RESULTS];
+    size_t total = findStudentsByNamePrefix(studentName, matches, MAX_SEARCH_RESULTS);
+    if (total == 0) {
+        printf("Student '%s' not found.\n", studentName);
+        int ids[MAX_SUGGESTIONS];
+        size_t similar = findStudentsBySimilarName(studentName, ids, MAX_SUGGESTIONS);
+        if (similar > 0) {
+            printf("Did you mean:\n");
+        }
+        for (size_t i = 0; i < similar && i < MAX_SUGGESTIONS; i++) {
+            Student *student = (Student *)hashIndexGet(&studentIdIndex, (uint32_t)ids[i]);
+            printf("  ID %d, Name: %s, Penalty Days: %d\n", student->studentId, student->studentName, student->penaltyDays);
+        }
+        return;
+    }
+    printf("Students starting with '%s':\n", studentName);
+    for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS; i++) {
+        printf("  ID %d, Name: %s, Penalty Days: %d\n", matches[i]->studentId, matches[i]->studentName, matches[i]->penaltyDays);
+    }
+    if (total > MAX_SEARCH_RESULTS) {
+        printf("  ... and %zu more\n", total - MAX_SEARCH_RESULTS);
+    }
+}
+
+// Print information for a specific student
+void printStudentInfo(Student *studentHead, BookLoan *loanHead) {
+    int studentId;
+    printf("Enter Student ID to view info: ");
+    scanf("%d", &studentId);
+    getchar(); 
+
+    Student *student = findStudentById(studentHead, studentId);
+    if (!student) {
+        printf("Student with ID %d not found.\n", studentId);
+        return;
+    }
+
+    printf("\n--- Student Information ---\n");
+    printf("ID: %d\n", student->studentId);
+    printf("Name: %s\n", student->studentName);
+    printf("Penalty Days: %d\n", student->penaltyDays);
+
+    printf("\nActive Loans:\n");
+    printStudentBookLoans(loanHead, studentId);
+
+    printf("---------------------------\n");
+}
+
+// Print book loans for a specific student
+void printStudentBookLoans(BookLoan *loanHead, int studentId) {
+    (void)loanHead;
+    int foundLoans = 0;
+    LoanChain *chain = getLoanChain(&studentLoanIndex, (uint32_t)studentId, 0);
+    BookLoan *tmp = chain ? chain->activeHead : NULL;
+    while (tmp != NULL) {
+        if (!foundLoans) {
+            printf("  Loan ID | Book ID | Example ID | Loan Date | Return Date\n");
+            printf("  --------|---------|------------|-----------|-------------\n");
+            foundLoans = 1;
+        }
+        char loanDate[MAX_DATE_LEN], returnDate[MAX_DATE_LEN];
+        formatDate(tmp->loanDay, loanDate);
+        formatDate(tmp->returnDay, returnDate);
+        printf("  %-7d | %-7d | %-10d | %-9s | %-11s\n",
+               tmp->loanId, tmp->bookId, tmp->exampleId, loanDate, returnDate);
+        tmp = tmp->nextActive;
+    }
+    if (!foundLoans) {
+        printf("  No active loans for this student.\n");
+    }
+}
+
+// Print students with penalty days, in the order they got them
+void printStudentsWithPenalty(Student *studentHead) {
+    (void)studentHead;
+    printf("\n--- Students with Penalty ---\n");
+    printf("ID | Student Name%*s | Penalty Days\n", MAX_NAME_LEN - 12, "");
+    printf("---|-------------%*s|--------------\n", MAX_NAME_LEN - 12, "");
+
+    int foundPenalty = 0;
+    for (Student *temp = penalizedHead; temp != NULL; temp = temp->nextPenalized) {
+        printf("%-2d | %-*s | %d\n", temp->studentId, MAX_NAME_LEN - 1, temp->studentName, temp->penaltyDays);
+        foundPenalty = 1;
+    }
+
+    if (!foundPenalty) {
+        printf("No students currently have penalty days.\n");
+    }
+    printf("-----------------------------\n");
+}
+
+
+// --- Bulk Delete Functions ---
+// A delete batch collects books, authors and students to delete and then
+// removes them all in one pass per table: one walk of each list, one
+// compaction of each name index and one compaction of the link array that
+// drops every link of a deleted book or author. Books with borrowed
+// examples and students with active loans are refused when added.
+// Returned loans of deleted books and students stay as loan history.
+// The single-row removes are batches of one row.
+
+// Add a row to a delete batch. Returns OP_OK, OP_NOT_FOUND, OP_IN_USE for
+// a book or student with active loans, or OP_NO_MEMORY. A row added twice
+// is deleted once.
+int deleteBatchAdd(DeleteBatch *batch, unsigned table, int id) {
+    HashIndex *rows;
+    void *row;
+    if (table == TABLE_BOOKS) {
+        Book *book = (Book *)hashIndexGet(&bookIdIndex, (uint32_t)id);
+        if (book && book->availableCount < book->exampleCount) {
+            return OP_IN_USE;
+        }
+        rows = &batch->books;
+        row = book;
+    } else if (table == TABLE_AUTHORS) {
+        rows = &batch->authors;
+        row = hashIndexGet(&authorIdIndex, (uint32_t)id);
+    } else {
+        Student *student = (Student *)hashIndexGet(&studentIdIndex, (uint32_t)id);
+        if (student && getLoanCountForStudent(NULL, id) > 0) {
+            return OP_IN_USE;
+        }
+        rows = &batch->students;
+        row = student;
+    }
+    if (!row) {
+        return OP_NOT_FOUND;
+    }
+    return hashIndexInsert(rows, (uint32_t)id, row) < 0 ? OP_NO_MEMORY : OP_OK;
+}
+
+// Name index callbacks: is the node one of the batch's rows?
+static int batchHasBook(const void *node, void *batch) {
+    const Book *book = (const Book *)node;
+    return hashIndexGet(&((DeleteBatch *)batch)->books, (uint32_t)book->bookId) == node;
+}
+
+static int batchHasAuthor(const void *node, void *batch) {
+    const Author *author = (const Author *)node;
+    return hashIndexGet(&((DeleteBatch *)batch)->authors, (uint32_t)author->authorId) == node;
+}
+
+static int batchHasStudent(const void *node, void *batch) {
+    const Student *student = (const Student *)node;
+    return hashIndexGet(&((DeleteBatch *)batch)->students, (uint32_t)student->studentId) == node;
+}
+
+// Unlink and free the batch's books in one walk of the list
+static void deleteBatchBooks(DeleteBatch *batch, Book **bookHead) {
+    nameIndexRemoveIf(&bookNameIndex, batchHasBook, batch);
+    wordIndexRemoveNodes(&bookWordIndex, &batch->books, offsetof(Book, bookName));
+    trigramIndexRemoveNodes(&bookTrigramIndex, &batch->books);
+    Book *prev = NULL;
+    Book *next;
+    for (Book *current = *bookHead; current != NULL; current = next) {
+        next = current->next;
+        if (hashIndexGet(&batch->books, (uint32_t)current->bookId) != current) {
+            prev = current;
+            continue;
+        }
+        if (prev == NULL) {
+            *bookHead = next;
+        } else {
+            prev->next = next;
+        }
+        if (bookTail == current) {
+            bookTail = prev;
+        }
+
+        hashIndexRemove(&bookIdIndex, (uint32_t)current->bookId);
+        uint64_t key = isbnKey(current->ISBN);
+        if (key != 0 && hashIndexGet(&isbnIndex, key) == current) {
+            hashIndexRemove(&isbnIndex, key);
+        }
+        journalDelete(JOURNAL_BOOK_DELETE, current->bookId);
+        freeBookExamples(current);
+        poolFree(&bookPool, current);
+        batch->deletedBooks++;
+    }
+}
+
+// Unlink and free the batch's authors in one walk of the list
+static void deleteBatchAuthors(DeleteBatch *batch, Author **authorHead) {
+    nameIndexRemoveIf(&authorNameIndex, batchHasAuthor, batch);
+    wordIndexRemoveNodes(&authorWordIndex, &batch->authors, offsetof(Author, authorName));
+    trigramIndexRemoveNodes(&authorTrigramIndex, &batch->authors);
+    Author *prev = NULL;
+    Author *next;
+    for (Author *current = *authorHead; current != NULL; current = next) {
+        next = current->next;
+        if (hashIndexGet(&batch->authors, (uint32_t)current->authorId) != current) {
+            prev = current;
+            continue;
+        }
+        if (prev == NULL) {
+            *authorHead = next;
+        } else {
+            prev->next = next;
+        }
+        if (authorTail == current) {
+            authorTail = prev;
+        }
+
+        hashIndexRemove(&authorIdIndex, (uint32_t)current->authorId);
+        journalDelete(JOURNAL_AUTHOR_DELETE, current->authorId);
+        poolFree(&authorPool, current);
+        batch->deletedAuthors++;
+    }
+}
+
+// Unlink and free the batch's students in one walk of the list
+static void deleteBatchStudents(DeleteBatch *batch, Student **studentHead) {
+    nameIndexRemoveIf(&studentNameIndex, batchHasStudent, batch);
+    trigramIndexRemoveNodes(&studentTrigramIndex, &batch->students);
+    Student *prev = NULL;
+    Student *next;
+    for (Student *current = *studentHead; current != NULL; current = next) {
+        next = current->next;
+        if (hashIndexGet(&batch->students, (uint32_t)current->studentId) != current) {
+            prev = current;
+            continue;
+        }
+        if (prev == NULL) {
+            *studentHead = next;
+        } else {
+            prev->next = next;
+        }
+        if (studentTail == current) {
+            studentTail = prev;
+        }
+
+        hashIndexRemove(&studentIdIndex, (uint32_t)current->studentId);
+        if (current->penaltyDays > 0) {
+            penalizedRemove(current);
+        }
+        journalDelete(JOURNAL_STUDENT_DELETE, current->studentId);
+        poolFree(&studentPool, current);
+        batch->deletedStudents++;
+    }
+}
+
+// Drop the links of the batch's books and authors in one compaction of the
+// link array. Must run before the rows themselves are freed.
+static void deleteBatchLinks(DeleteBatch *batch, BookAuthor *bookAuthorArray, int *bookAuthorCount) {
+    int kept = 0;
+    for (int i = 0; i < *bookAuthorCount; i++) {
+        BookAuthor *link = &bookAuthorArray[i];
+        if (hashIndexGet(&batch->books, (uint32_t)link->bookId) ||
+            hashIndexGet(&batch->authors, (uint32_t)link->authorId)) {
+            if (linkSetBuilt) {
+                hashIndexRemove(&linkSet, linkKey(link->bookId, link->authorId));
+            }
+        } else {
+            bookAuthorArray[kept++] = *link;
+        }
+    }
+    if (kept < *bookAuthorCount) {
+        batch->removedLinks += *bookAuthorCount - kept;
+        *bookAuthorCount = kept;
+        markTablesDirty(TABLE_LINKS);
+        __atomic_store_n(&linkIndexesBuilt, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// Delete every row of the batch, with the links of its books and authors,
+// and add the counts to the batch. The heads of tables the batch has no
+// rows for may be NULL. Rows are journaled one by one, so replaying the
+// journal repeats the cascade.
+void deleteBatchRun(DeleteBatch *batch, Book **bookHead, Author **authorHead, Student **studentHead,
+                    BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    if (batch->books.count > 0 || batch->authors.count > 0) {
+        deleteBatchLinks(batch, *bookAuthorArray, bookAuthorCount);
+    }
+    if (batch->books.count > 0) {
+        deleteBatchBooks(batch, bookHead);
+    }
+    if (batch->authors.count > 0) {
+        deleteBatchAuthors(batch, authorHead);
+    }
+    if (batch->students.count > 0) {
+        deleteBatchStudents(batch, studentHead);
+    }
+    hashIndexFree(&batch->books);
+    hashIndexFree(&batch->authors);
+    hashIndexFree(&batch->students);
+}
+
+// Release a batch that was not run
+void deleteBatchFree(DeleteBatch *batch) {
+    hashIndexFree(&batch->books);
+    hashIndexFree(&batch->authors);
+    hashIndexFree(&batch->students);
+}
+
+
+// --- ID Sequence Functions ---
+
+// Load the persisted ID sequences. Called after the tables are loaded; a
+// sequence only ever moves forward, so the larger of the stored value and
+// the highest loaded ID wins.
+void loadSequences() {
+    FILE *file = fopen("sayaclar.csv", "r");
+    if (!file) {
+        return;
+    }
+
+    char line[MAX_LINE_LEN];
+
+    // Skip header row
+    fgets(line, sizeof(line), file);
+
+    while (fgets(line, sizeof(line), file)) {
+        // Parse CSV line: table,nextId
+        char table[MAX_NAME_LEN];
+        int nextId;
+        if (sscanf(line, "%99[^,],%d", table, &nextId) != 2) {
+            continue;
+        }
+        if (strcmp(table, "lastPenaltyDay") == 0) {
+            int32_t day;
+            if (parseDate(line + strlen(table) + 1, &day) == 0 && day > lastPenaltyDay) {
+                lastPenaltyDay = day;
+            }
+            continue;
+        }
+
+        int *sequence = NULL;
+        if (strcmp(table, "books") == 0) {
+            sequence = &nextBookId;
+        } else if (strcmp(table, "authors") == 0) {
+            sequence = &nextAuthorId;
+        } else if (strcmp(table, "students") == 0) {
+            sequence = &nextStudentId;
+        } else if (strcmp(table, "loans") == 0) {
+            sequence = &nextLoanId;
+        }
+        if (sequence && nextId > *sequence) {
+            *sequence = nextId;
+        }
+    }
+    fclose(file);
+}
+
+// Save the ID sequences to CSV. Returns 0 on success, -1 on error.
+int saveSequences() {
+    FILE *file = openForRewrite("sayaclar.csv");
+    if (!file) {
+        return -1;
+    }
+
+    // Write header
+    fprintf(file, "table,nextId\n");
+    fprintf(file, "books,%d\n", nextBookId);
+    fprintf(file, "authors,%d\n", nextAuthorId);
+    fprintf(file, "students,%d\n", nextStudentId);
+    fprintf(file, "loans,%d\n", nextLoanId);
+    if (lastPenaltyDay > 0) {
+        char date[MAX_DATE_LEN];
+        formatDate(lastPenaltyDay, date);
+        fprintf(file, "lastPenaltyDay,%s\n", date);
+    }
+    return finishRewrite(file, "sayaclar.csv");
+}
+
+
+// --- Snapshot Functions ---
+// kutuphane.snap holds every table in binary form. Layout: SnapshotHeader,
+// then SNAPSHOT_SECTION_COUNT SnapshotSection entries, then the sections,
+// each starting on an 8-byte boundary. Records are fixed-width in host
+// byte order; names and ISBNs are offsets into the string heap section,
+// which holds null-terminated strings. The snapshot is loaded instead of
+// the CSV files when it is at least as new as all of them, so editing a
+// CSV file by hand imports it on the next start.
+
+// CRC32C (Castagnoli) lookup table for the software fallback
+static uint32_t crc32cTable[256];
+
+// Update a CRC32C one byte at a time through the lookup table
+uint32_t crc32cSoftware(uint32_t crc, const unsigned char *data, size_t size) {
+    while (size--) {
+        crc = crc32cTable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+// Update a CRC32C with the SSE4.2 crc32 instruction, 8 bytes at a time
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(uint32_t crc, const unsigned char *data, size_t size) {
+    uint64_t value = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        value = _mm_crc32_u64(value, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = (uint32_t)value;
+    while (size--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+// CRC32C implementation picked for this CPU; set once, snapshot loading
+// runs on threads
+static uint32_t (*crc32cImpl)(uint32_t, const unsigned char *, size_t);
+static pthread_once_t crc32cOnce = PTHREAD_ONCE_INIT;
+
+// Pick the SSE4.2 CRC32C when the CPU has it, otherwise build the table
+void crc32cInit(void) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc32cImpl = crc32cHardware;
+        return;
+    }
+#endif
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++) {
+            value = (value >> 1) ^ (0x82F63B78u & (0u - (value & 1)));
+        }
+        crc32cTable[i] = value;
+    }
+    crc32cImpl = crc32cSoftware;
+}
+
+// CRC32C of a buffer
+uint32_t crc32c(const void *data, size_t size) {
+    pthread_once(&crc32cOnce, crc32cInit);
+    return ~crc32cImpl(~0u, (const unsigned char *)data, size);
+}
+
+// Append a string to the heap and return its offset, or UINT32_MAX if
+// memory runs out
+uint32_t stringHeapAdd(StringHeap *heap, const char *text) {
+    size_t length = strlen(text) + 1;
+    if (heap->size + length > heap->capacity) {
+        size_t newCapacity = heap->capacity ? heap->capacity * 2 : 4096;
+        while (newCapacity < heap->size + length) {
+            newCapacity *= 2;
+        }
+        char *grown = (char *)realloc(heap->data, newCapacity);
+        if (!grown) {
+            return UINT32_MAX;
+        }
+        heap->data = grown;
+        heap->capacity = newCapacity;
+    }
+    uint32_t offset = (uint32_t)heap->size;
+    memcpy(heap->data + heap->size, text, length);
+    heap->size += length;
+    return offset;
+}
+
+// 1 if kutuphane.snap exists and no CSV file was modified after it
+int snapshotIsCurrent() {
+    static const char *csvFiles[] = {
+        "kitaplar.csv", "yazarlar.csv", "ogrenciler.csv",
+        "kitap_odunc.csv", "kitap_yazar.csv", "sayaclar.csv"
+    };
+    struct stat snapStat;
+    if (stat(SNAPSHOT_FILE, &snapStat) != 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(csvFiles) / sizeof(csvFiles[0]); i++) {
+        struct stat csvStat;
+        if (stat(csvFiles[i], &csvStat) != 0) {
+            continue;
+        }
+        if (csvStat.st_mtim.tv_sec > snapStat.st_mtim.tv_sec ||
+            (csvStat.st_mtim.tv_sec == snapStat.st_mtim.tv_sec &&
+             csvStat.st_mtim.tv_nsec > snapStat.st_mtim.tv_nsec)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Write one section: fill in its table entry, pad the file to 8 bytes and
+// write the data. Returns 0 on success, -1 on a write error.
+int writeSnapshotSection(FILE *file, SnapshotSection *section, uint32_t type, uint32_t recordSize,
+                         const void *data, uint64_t count) {
+    static const char padding[8];
+    long position = ftell(file);
+    size_t pad = (size_t)(-position & 7);
+    if (pad && fwrite(padding, 1, pad, file) != pad) {
+        return -1;
+    }
+    size_t size = (size_t)(recordSize * count);
+    section->type = type;
+    section->recordSize = recordSize;
+    section->offset = (uint64_t)position + pad;
+    section->count = count;
+    section->crc = crc32c(data, size);
+    section->reserved = 0;
+    if (size && fwrite(data, 1, size, file) != size) {
+        return -1;
+    }
+    return 0;
+}
+
+// Copy a section unchanged from the previous snapshot, keeping its
+// checksum. Returns 0 on success, -1 on a read or write error.
+int copySnapshotSection(FILE *file, int oldFd, const SnapshotSection *oldSection, SnapshotSection *section) {
+    static const char padding[8];
+    char buffer[64 * 1024];
+    long position = ftell(file);
+    size_t pad = (size_t)(-position & 7);
+    if (pad && fwrite(padding, 1, pad, file) != pad) {
+        return -1;
+    }
+    *section = *oldSection;
+    section->offset = (uint64_t)position + pad;
+
+    uint64_t remaining = oldSection->count * oldSection->recordSize;
+    off_t offset = (off_t)oldSection->offset;
+    while (remaining > 0) {
+        size_t chunk = remaining < sizeof(buffer) ? (size_t)remaining : sizeof(buffer);
+        ssize_t n = pread(oldFd, buffer, chunk, offset);
+        if (n <= 0 || fwrite(buffer, 1, (size_t)n, file) != (size_t)n) {
+            return -1;
+        }
+        offset += n;
+        remaining -= (uint64_t)n;
+    }
+    return 0;
+}
+
+// Open the current snapshot and read its section table, for reusing the
+// sections of unchanged tables. Returns the descriptor, or -1 if there is
+// no usable snapshot or it does not hold the loaded tables.
+int openPreviousSnapshot(SnapshotSection *sections) {
+    if (snapshotDirtyTables == TABLE_ALL) {
+        return -1;
+    }
+    int fd = open(SNAPSHOT_FILE, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    SnapshotHeader header;
+    size_t tableSize = sizeof(SnapshotSection) * SNAPSHOT_SECTION_COUNT;
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        pread(fd, sections, tableSize, sizeof(header)) != (ssize_t)tableSize ||
+        memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION || header.tableCrc != crc32c(sections, tableSize)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Save all tables to kutuphane.snap. Sections whose tables are unchanged
+// since the snapshot was last loaded or written are copied over from the
+// previous file instead of being encoded again. The file is written under
+// a temporary name and renamed into place, so a failed save keeps the old
+// snapshot. Returns 0 on success, -1 on error.
+int saveSnapshot(Book *bookHead, Author *authorHead, Student *studentHead,
+                 BookLoan *loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount) {
+    // Tables each section is built from
+    static const unsigned sectionTables[SNAPSHOT_SECTION_COUNT] = {
+        TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS, // Books (share the string heap)
+        TABLE_BOOKS | TABLE_LOANS, // Examples
+        TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS, // Authors
+        TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS, // Students
+        TABLE_LOANS,
+        TABLE_LINKS,
+        TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS // Strings
+    };
+    SnapshotHeader header;
+    SnapshotSection sections[SNAPSHOT_SECTION_COUNT];
+    SnapshotSection oldSections[SNAPSHOT_SECTION_COUNT];
+    int reuse[SNAPSHOT_SECTION_COUNT];
+    StringHeap strings = { NULL, 0, 0 };
+    size_t bookCount = 0, wordCount = 0, authorCount = 0, studentCount = 0, loanCount = 0;
+    SnapshotBook *books = NULL;
+    uint64_t *words = NULL;
+    SnapshotAuthor *authors = NULL;
+    SnapshotStudent *students = NULL;
+    SnapshotLoan *loans = NULL;
+    SnapshotBookAuthor *links = NULL;
+    FILE *file = NULL;
+    int failed = 1;
+
+    int oldFd = openPreviousSnapshot(oldSections);
+    for (int i = 0; i < SNAPSHOT_SECTION_COUNT; i++) {
+        reuse[i] = oldFd >= 0 && (snapshotDirtyTables & sectionTables[i]) == 0;
+    }
+
+    if (!reuse[SNAPSHOT_BOOKS] || !reuse[SNAPSHOT_EXAMPLES]) {
+        for (Book *b = bookHead; b; b = b->next) {
+            bookCount++;
+            wordCount += (size_t)(b->exampleCount + 63) / 64;
+        }
+        books = (SnapshotBook *)malloc(sizeof(SnapshotBook) * (bookCount + 1));
+        words = (uint64_t *)malloc(sizeof(uint64_t) * (wordCount + 1));
+        if (!books || !words) {
+            perror("Memory allocation failed");
+            goto done;
+        }
+        size_t i = 0, w = 0;
+        for (Book *b = bookHead; b; b = b->next, i++) {
+            books[i].bookId = b->bookId;
+            books[i].exampleCount = b->exampleCount;
+            if (!reuse[SNAPSHOT_BOOKS]) {
+                books[i].nameOffset = stringHeapAdd(&strings, b->bookName);
+                books[i].isbnOffset = stringHeapAdd(&strings, b->ISBN);
+                if (books[i].nameOffset == UINT32_MAX || books[i].isbnOffset == UINT32_MAX) {
+                    perror("Memory allocation failed");
+                    goto done;
+                }
+            }
+            size_t bookWords = (size_t)(b->exampleCount + 63) / 64;
+            memcpy(words + w, bookExampleWords(b), sizeof(uint64_t) * bookWords);
+            w += bookWords;
+        }
+    }
+    if (!reuse[SNAPSHOT_AUTHORS]) {
+        for (Author *a = authorHead; a; a = a->next) {
+            authorCount++;
+        }
+        authors = (SnapshotAuthor *)malloc(sizeof(SnapshotAuthor) * (authorCount + 1));
+        if (!authors) {
+            perror("Memory allocation failed");
+            goto done;
+        }
+        size_t i = 0;
+        for (Author *a = authorHead; a; a = a->next, i++) {
+            authors[i].authorId = a->authorId;
+            authors[i].nameOffset = stringHeapAdd(&strings, a->authorName);
+            if (authors[i].nameOffset == UINT32_MAX) {
+                perror("Memory allocation failed");
+                goto done;
+            }
+        }
+    }
+    if (!reuse[SNAPSHOT_STUDENTS]) {
+        for (Student *s = studentHead; s; s = s->next) {
+            studentCount++;
+        }
+        students = (SnapshotStudent *)malloc(sizeof(SnapshotStudent) * (studentCount + 1));
+        if (!students) {
+            perror("Memory allocation failed");
+            goto done;
+        }
+        size_t i = 0;
+        for (Student *s = studentHead; s; s = s->next, i++) {
+            students[i].studentId = s->studentId;
+            students[i].penaltyDays = s->penaltyDays;
+            students[i].nameOffset = stringHeapAdd(&strings, s->studentName);
+            if (students[i].nameOffset == UINT32_MAX) {
+                perror("Memory allocation failed");
+                goto done;
+            }
+        }
+    }
+    if (!reuse[SNAPSHOT_LOANS]) {
+        for (BookLoan *l = loanHead; l; l = l->next) {
+            loanCount++;
+        }
+        loans = (SnapshotLoan *)malloc(sizeof(SnapshotLoan) * (loanCount + 1));
+        if (!loans) {
+            perror("Memory allocation failed");
+            goto done;
+        }
+        size_t i = 0;
+        for (BookLoan *l = loanHead; l; l = l->next, i++) {
+            loans[i].loanId = l->loanId;
+            loans[i].bookId = l->bookId;
+            loans[i].exampleId = l->exampleId;
+            loans[i].studentId = l->studentId;
+            loans[i].loanDay = l->loanDay;
+            loans[i].returnDay = l->returnDay;
+            loans[i].returned = l->returned;
+        }
+    }
+    if (!reuse[SNAPSHOT_BOOK_AUTHORS]) {
+        links = (SnapshotBookAuthor *)malloc(sizeof(SnapshotBookAuthor) * (bookAuthorCount + 1));
+        if (!links) {
+            perror("Memory allocation failed");
+            goto done;
+        }
+        for (int j = 0; j < bookAuthorCount; j++) {
+            links[j].bookId = bookAuthorArray[j].bookId;
+            links[j].authorId = bookAuthorArray[j].authorId;
+        }
+    }
+
+    file = openForRewrite(SNAPSHOT_FILE);
+    if (!file) {
+        goto done;
+    }
+
+    // Header and section table are rewritten once the offsets are known
+    memset(&header, 0, sizeof(header));
+    memset(sections, 0, sizeof(sections));
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(sections, sizeof(sections), 1, file) != 1) {
+        goto done;
+    }
+    const void *sectionData[SNAPSHOT_SECTION_COUNT] = { books, words, authors, students, loans, links, strings.data };
+    const uint64_t sectionCounts[SNAPSHOT_SECTION_COUNT] = {
+        bookCount, wordCount, authorCount, studentCount, loanCount, (uint64_t)bookAuthorCount, strings.size
+    };
+    static const uint32_t recordSizes[SNAPSHOT_SECTION_COUNT] = {
+        sizeof(SnapshotBook), sizeof(uint64_t), sizeof(SnapshotAuthor), sizeof(SnapshotStudent),
+        sizeof(SnapshotLoan), sizeof(SnapshotBookAuthor), 1
+    };
+    for (int i = 0; i < SNAPSHOT_SECTION_COUNT; i++) {
+        int status = reuse[i]
+            ? copySnapshotSection(file, oldFd, &oldSections[i], &sections[i])
+            : writeSnapshotSection(file, &sections[i], (uint32_t)i, recordSizes[i], sectionData[i], sectionCounts[i]);
+        if (status != 0) {
+            goto done;
+        }
+    }
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.sectionCount = SNAPSHOT_SECTION_COUNT;
+    header.nextBookId = nextBookId;
+    header.nextAuthorId = nextAuthorId;
+    header.nextStudentId = nextStudentId;
+    header.nextLoanId = nextLoanId;
+    header.lastPenaltyDay = lastPenaltyDay;
+    header.tableCrc = crc32c(sections, sizeof(sections));
+    if (fseek(file, 0, SEEK_SET) != 0 ||
+        fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(sections, sizeof(sections), 1, file) != 1) {
+        goto done;
+    }
+    failed = 0;
+
+done:
+    if (file) {
+        if (failed) {
+            abandonRewrite(file, SNAPSHOT_FILE);
+        } else if (finishRewrite(file, SNAPSHOT_FILE) != 0) {
+            failed = 1;
+        } else {
+            snapshotDirtyTables = 0;
+        }
+    }
+    if (oldFd >= 0) {
+        close(oldFd);
+    }
+    free(books);
+    free(words);
+    free(authors);
+    free(students);
+    free(loans);
+    free(links);
+    free(strings.data);
+    return failed ? -1 : 0;
+}
+
+// Check that a string heap offset points at a null-terminated string
+// shorter than limit
+int snapshotStringValid(const char *heap, uint64_t heapSize, uint32_t offset, size_t limit) {
+    if (offset >= heapSize) {
+        return 0;
+    }
+    size_t available = (size_t)(heapSize - offset);
+    return memchr(heap + offset, '\0', available < limit ? available : limit) != NULL;
+}
+
+// Load all tables from kutuphane.snap. The whole file is validated before
+// any table is touched, so on failure (-1) the caller can still fall back
+// to the CSV files. Returns 0 on success.
+int loadSnapshot(Book **bookHead, Author **authorHead, Student **studentHead,
+                 BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    int fd = open(SNAPSHOT_FILE, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader) + sizeof(SnapshotSection) * SNAPSHOT_SECTION_COUNT) {
+        fprintf(stderr, SNAPSHOT_FILE ": file too short, loading CSV files\n");
+        close(fd);
+        return -1;
+    }
+    size_t fileSize = (size_t)st.st_size;
+    void *map = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Error mapping " SNAPSHOT_FILE);
+        return -1;
+    }
+    const char *data = (const char *)map;
+
+    // Validate the header, the section table and every section checksum
+    SnapshotHeader header;
+    SnapshotSection sections[SNAPSHOT_SECTION_COUNT];
+    memcpy(&header, data, sizeof(header));
+    memcpy(sections, data + sizeof(header), sizeof(sections));
+    const char *problem = NULL;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        problem = "not a snapshot file";
+    } else if (header.version != SNAPSHOT_VERSION || header.sectionCount != SNAPSHOT_SECTION_COUNT) {
+        problem = "unsupported snapshot version";
+    } else if (header.tableCrc != crc32c(sections, sizeof(sections))) {
+        problem = "section table checksum mismatch";
+    }
+    static const uint32_t recordSizes[SNAPSHOT_SECTION_COUNT] = {
+        sizeof(SnapshotBook), sizeof(uint64_t), sizeof(SnapshotAuthor), sizeof(SnapshotStudent),
+        sizeof(SnapshotLoan), sizeof(SnapshotBookAuthor), 1
+    };
+    for (int i = 0; !problem && i < SNAPSHOT_SECTION_COUNT; i++) {
+        const SnapshotSection *section = &sections[i];
+        if (section->type != (uint32_t)i || section->recordSize != recordSizes[i] ||
+            section->offset % 8 != 0 || section->offset > fileSize ||
+            section->count > (fileSize - section->offset) / section->recordSize) {
+            problem = "corrupt section table";
+        } else if (crc32c(data + section->offset, (size_t)(section->count * section->recordSize)) != section->crc) {
+            problem = "section checksum mismatch";
+        }
+    }
+
+    const SnapshotBook *books = (const SnapshotBook *)(data + sections[SNAPSHOT_BOOKS].offset);
+    const uint64_t *words = (const uint64_t *)(data + sections[SNAPSHOT_EXAMPLES].offset);
+    const SnapshotAuthor *authors = (const SnapshotAuthor *)(data + sections[SNAPSHOT_AUTHORS].offset);
+    const SnapshotStudent *students = (const SnapshotStudent *)(data + sections[SNAPSHOT_STUDENTS].offset);
+    const SnapshotLoan *loans = (const SnapshotLoan *)(data + sections[SNAPSHOT_LOANS].offset);
+    const SnapshotBookAuthor *links = (const SnapshotBookAuthor *)(data + sections[SNAPSHOT_BOOK_AUTHORS].offset);
+    const char *heap = data + sections[SNAPSHOT_STRINGS].offset;
+    uint64_t heapSize = sections[SNAPSHOT_STRINGS].count;
+    size_t bookCount = (size_t)sections[SNAPSHOT_BOOKS].count;
+    size_t authorCount = (size_t)sections[SNAPSHOT_AUTHORS].count;
+    size_t studentCount = (size_t)sections[SNAPSHOT_STUDENTS].count;
+    size_t loanCount = (size_t)sections[SNAPSHOT_LOANS].count;
+    size_t linkCount = (size_t)sections[SNAPSHOT_BOOK_AUTHORS].count;
+
+    // Records refer to the string heap and the example words by offset
+    uint64_t wordsNeeded = 0;
+    for (size_t i = 0; !problem && i < bookCount; i++) {
+        if (books[i].exampleCount < 0 ||
+            !snapshotStringValid(heap, heapSize, books[i].nameOffset, MAX_NAME_LEN) ||
+            !snapshotStringValid(heap, heapSize, books[i].isbnOffset, MAX_ISBN_LEN)) {
+            problem = "invalid book record";
+        }
+        wordsNeeded += (uint64_t)(books[i].exampleCount + 63) / 64;
+    }
+    if (!problem && wordsNeeded != sections[SNAPSHOT_EXAMPLES].count) {
+        problem = "example bitmap size mismatch";
+    }
+    for (size_t i = 0; !problem && i < authorCount; i++) {
+        if (!snapshotStringValid(heap, heapSize, authors[i].nameOffset, MAX_NAME_LEN)) {
+            problem = "invalid author record";
+        }
+    }
+    for (size_t i = 0; !problem && i < studentCount; i++) {
+        if (!snapshotStringValid(heap, heapSize, students[i].nameOffset, MAX_NAME_LEN)) {
+            problem = "invalid student record";
+        }
+    }
+    if (!problem && linkCount > INT32_MAX) {
+        problem = "too many book-author links";
+    }
+    if (problem) {
+        fprintf(stderr, SNAPSHOT_FILE ": %s, loading CSV files\n", problem);
+        munmap(map, fileSize);
+        return -1;
+    }
+
+    madvise(map, fileSize, MADV_SEQUENTIAL);
+
+    SnapshotView view = { books, words, authors, students, loans, links, heap,
+                          bookCount, authorCount, studentCount, loanCount, linkCount };
+    loadTables(&view, bookHead, authorHead, studentHead, loanHead, bookAuthorArray, bookAuthorCount);
+
+    // Sequences never move backwards (see loadSequences)
+    if (header.nextBookId > nextBookId) {
+        nextBookId = header.nextBookId;
+    }
+    if (header.nextAuthorId > nextAuthorId) {
+        nextAuthorId = header.nextAuthorId;
+    }
+    if (header.nextStudentId > nextStudentId) {
+        nextStudentId = header.nextStudentId;
+    }
+    if (header.nextLoanId > nextLoanId) {
+        nextLoanId = header.nextLoanId;
+    }
+    if (header.lastPenaltyDay > lastPenaltyDay) {
+        lastPenaltyDay = header.lastPenaltyDay;
+    }
+
+    munmap(map, fileSize);
+    snapshotDirtyTables = 0;
+    return 0;
+}
+
+
+// Build the book list, its examples and indexes from a loaded snapshot
+void snapshotLoadBooks(const SnapshotView *view, Book **bookHead) {
+    Book *lastBook = NULL;
+    const uint64_t *bookWords = view->words;
+    for (size_t i = 0; i < view->bookCount; i++) {
+        const SnapshotBook *record = &view->books[i];
+        Book *newBook = (Book *)poolAlloc(&bookPool);
+        if (!newBook) {
+            perror("Memory allocation failed");
+            break;
+        }
+        newBook->bookId = record->bookId;
+        strcpy(newBook->bookName, view->heap + record->nameOffset);
+        strcpy(newBook->ISBN, view->heap + record->isbnOffset);
+        if (createBookExamples(newBook, record->exampleCount) != 0) {
+            poolFree(&bookPool, newBook);
+            break;
+        }
+        int exampleWords = (newBook->exampleCount + 63) / 64;
+        uint64_t *bits = bookExampleWords(newBook);
+        int borrowed = 0;
+        for (int w = 0; w < exampleWords; w++) {
+            int unused = 64 * (w + 1) - newBook->exampleCount;
+            bits[w] = unused > 0 ? bookWords[w] & (~0ULL >> unused) : bookWords[w];
+            borrowed += __builtin_popcountll(bits[w]);
+        }
+        bookWords += exampleWords;
+        newBook->availableCount = newBook->exampleCount - borrowed;
+        if (linkLoadedBook(newBook, bookHead, &lastBook) != 0) {
+            freeBookExamples(newBook);
+            poolFree(&bookPool, newBook);
+        }
+    }
+    bookTail = lastBook;
+    nameIndexSort(&bookNameIndex);
+}
+
+// Build the author list and its indexes from a loaded snapshot
+void snapshotLoadAuthors(const SnapshotView *view, Author **authorHead) {
+    Author *lastAuthor = NULL;
+    for (size_t i = 0; i < view->authorCount; i++) {
+        Author *newAuthor = (Author *)poolAlloc(&authorPool);
+        if (!newAuthor) {
+            perror("Memory allocation failed");
+            break;
+        }
+        newAuthor->authorId = view->authors[i].authorId;
+        strcpy(newAuthor->authorName, view->heap + view->authors[i].nameOffset);
+        if (linkLoadedAuthor(newAuthor, authorHead, &lastAuthor) != 0) {
+            poolFree(&authorPool, newAuthor);
+        }
+    }
+    authorTail = lastAuthor;
+    nameIndexSort(&authorNameIndex);
+}
+
+// Build the student list and its indexes from a loaded snapshot
+void snapshotLoadStudents(const SnapshotView *view, Student **studentHead) {
+    Student *lastStudent = NULL;
+    for (size_t i = 0; i < view->studentCount; i++) {
+        Student *newStudent = (Student *)poolAlloc(&studentPool);
+        if (!newStudent) {
+            perror("Memory allocation failed");
+            break;
+        }
+        newStudent->studentId = view->students[i].studentId;
+        newStudent->penaltyDays = view->students[i].penaltyDays;
+        strcpy(newStudent->studentName, view->heap + view->students[i].nameOffset);
+        if (linkLoadedStudent(newStudent, studentHead, &lastStudent) != 0) {
+            poolFree(&studentPool, newStudent);
+        }
+    }
+    studentTail = lastStudent;
+    nameIndexSort(&studentNameIndex);
+}
+
+// Build the loan list and the loan indexes from a loaded snapshot
+void snapshotLoadLoans(const SnapshotView *view, BookLoan **loanHead) {
+    BookLoan *lastLoan = NULL;
+    for (size_t i = 0; i < view->loanCount; i++) {
+        const SnapshotLoan *record = &view->loans[i];
+        BookLoan *newLoan = (BookLoan *)poolAlloc(&loanPool);
+        if (!newLoan) {
+            perror("Memory allocation failed");
+            break;
+        }
+        newLoan->loanId = record->loanId;
+        newLoan->bookId = record->bookId;
+        newLoan->exampleId = record->exampleId;
+        newLoan->studentId = record->studentId;
+        newLoan->loanDay = record->loanDay;
+        newLoan->returnDay = record->returnDay;
+        newLoan->returned = record->returned != 0;
+        if (linkLoadedLoan(newLoan, loanHead, &lastLoan) != 0) {
+            poolFree(&loanPool, newLoan);
+        }
+    }
+    loanTail = lastLoan;
+}
+
+// Copy the book-author links out of a loaded snapshot
+void snapshotLoadLinks(const SnapshotView *view, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    *bookAuthorArray = NULL;
+    *bookAuthorCount = 0;
+    if (view->linkCount == 0) {
+        return;
+    }
+    *bookAuthorArray = (BookAuthor *)malloc(sizeof(BookAuthor) * view->linkCount);
+    if (!*bookAuthorArray) {
+        perror("Memory allocation failed");
+        return;
+    }
+    for (size_t i = 0; i < view->linkCount; i++) {
+        (*bookAuthorArray)[i].bookId = view->links[i].bookId;
+        (*bookAuthorArray)[i].authorId = view->links[i].authorId;
+        (*bookAuthorArray)[i].next = NULL;
+    }
+    *bookAuthorCount = (int)view->linkCount;
+    resetBookAuthorIndexes(*bookAuthorCount);
+}
+
+// --- Journal Functions ---
+// Every change to a table is appended to kutuphane.wal as one record, so a
+// session survives a crash without saving everything. Records are
+// after-images (the full row for an add or update, the ID for a delete),
+// which makes replaying them idempotent: a crash between writing a
+// checkpoint and truncating the journal only replays changes the
+// checkpoint already holds. Record layout:
+//   uint32 crc (CRC32C of the rest), uint16 payload length, uint8 type,
+//   payload (int32 fields and uint8-length-prefixed strings)
+// The file starts with JOURNAL_MAGIC. A torn or corrupt record ends the
+// replay and is cut off.
+
+// Open the journal for appending, creating it if needed.
+// Returns 0 on success, -1 if the journal is unavailable.
+int journalOpen() {
+    journal.fd = open(JOURNAL_FILE, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (journal.fd < 0) {
+        perror("Error opening " JOURNAL_FILE);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(journal.fd, &st) == 0 && st.st_size == 0) {
+        if (write(journal.fd, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE) != JOURNAL_HEADER_SIZE) {
+            perror("Error writing " JOURNAL_FILE);
+        }
+        fdatasync(journal.fd);
+    }
+    journal.size = 0;
+    journal.unsynced = 0;
+    journal.lastSync = time(NULL);
+    return 0;
+}
+
+// Write the buffered records to the file. With force set, or when
+// JOURNAL_SYNC_RECORDS records or JOURNAL_SYNC_SECONDS have gone by since
+// the last fdatasync, the file is synced as well, so a burst of changes
+// shares one sync. The caller holds journalLock.
+static void journalFlush(int force) {
+    if (journal.fd < 0) {
+        return;
+    }
+    size_t written = 0;
+    while (written < journal.size) {
+        ssize_t n = write(journal.fd, journal.buffer + written, journal.size - written);
+        if (n <= 0) {
+            perror("Error writing " JOURNAL_FILE);
+            break;
+        }
+        written += (size_t)n;
+    }
+    journal.fileSize += written;
+    journal.size = 0;
+
+    time_t now = time(NULL);
+    if (journal.unsynced > 0 &&
+        (force || journal.unsynced >= JOURNAL_SYNC_RECORDS || now - journal.lastSync >= JOURNAL_SYNC_SECONDS)) {
+        fdatasync(journal.fd);
+        journal.unsynced = 0;
+        journal.lastSync = now;
+    }
+}
+
+// Write (and maybe sync) the buffered records, see journalFlush
+void journalCommit(int force) {
+    pthread_mutex_lock(&journalLock);
+    journalFlush(force);
+    pthread_mutex_unlock(&journalLock);
+}
+
+// 1 once the journal has grown enough that a checkpoint should be taken
+int journalCheckpointDue() {
+    pthread_mutex_lock(&journalLock);
+    int due = journal.fd >= 0 && journal.fileSize >= JOURNAL_CHECKPOINT_BYTES;
+    pthread_mutex_unlock(&journalLock);
+    return due;
+}
+
+// Drop every record after a checkpoint has been written
+void journalTruncate() {
+    pthread_mutex_lock(&journalLock);
+    if (journal.fd >= 0) {
+        journal.size = 0;
+        if (ftruncate(journal.fd, JOURNAL_HEADER_SIZE) != 0) {
+            perror("Error truncating " JOURNAL_FILE);
+        } else {
+            fdatasync(journal.fd);
+            journal.fileSize = 0;
+            journal.unsynced = 0;
+        }
+    }
+    pthread_mutex_unlock(&journalLock);
+}
+
+// Commit outstanding records and close the journal
+void journalClose() {
+    pthread_mutex_lock(&journalLock);
+    if (journal.fd >= 0) {
+        journalFlush(1);
+        close(journal.fd);
+        journal.fd = -1;
+    }
+    pthread_mutex_unlock(&journalLock);
+}
+
+// Append one record to the buffer and mark its table dirty. Nothing is
+// logged while the journal is closed or being replayed.
+void journalAppend(int type, const unsigned char *payload, size_t length) {
+    // Table changed by each record type
+    static const unsigned recordTables[] = {
+        0, TABLE_BOOKS, TABLE_BOOKS, TABLE_AUTHORS, TABLE_AUTHORS,
+        TABLE_STUDENTS, TABLE_STUDENTS, TABLE_LOANS, TABLE_LOANS, TABLE_LINKS, TABLE_STUDENTS
+    };
+    markTablesDirty(recordTables[type]);
+
+    pthread_mutex_lock(&journalLock);
+    if (journal.fd < 0 || journal.replaying) {
+        pthread_mutex_unlock(&journalLock);
+        return;
+    }
+    size_t recordSize = 7 + length;
+    if (journal.size + recordSize > sizeof(journal.buffer)) {
+        journalFlush(0);
+    }
+    unsigned char *record = (unsigned char *)journal.buffer + journal.size;
+    uint16_t length16 = (uint16_t)length;
+    memcpy(record + 4, &length16, sizeof(length16));
+    record[6] = (unsigned char)type;
+    memcpy(record + 7, payload, length);
+    uint32_t crc = crc32c(record + 4, 3 + length);
+    memcpy(record, &crc, sizeof(crc));
+    journal.size += recordSize;
+    journal.unsynced++;
+    pthread_mutex_unlock(&journalLock);
+}
+
+// Payload encoding helpers
+static size_t journalPutInt(unsigned char *payload, size_t pos, int32_t value) {
+    memcpy(payload + pos, &value, sizeof(value));
+    return pos + sizeof(value);
+}
+
+static size_t journalPutString(unsigned char *payload, size_t pos, const char *text) {
+    size_t length = strlen(text);
+    if (length > 255) {
+        length = 255; // Names are shorter than MAX_NAME_LEN anyway
+    }
+    payload[pos] = (unsigned char)length;
+    memcpy(payload + pos + 1, text, length);
+    return pos + 1 + length;
+}
+
+void journalBookPut(const Book *book) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, book->bookId);
+    pos = journalPutInt(payload, pos, book->exampleCount);
+    pos = journalPutString(payload, pos, book->bookName);
+    pos = journalPutString(payload, pos, book->ISBN);
+    journalAppend(JOURNAL_BOOK_PUT, payload, pos);
+}
+
+void journalAuthorPut(const Author *author) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, author->authorId);
+    pos = journalPutString(payload, pos, author->authorName);
+    journalAppend(JOURNAL_AUTHOR_PUT, payload, pos);
+}
+
+void journalStudentPut(const Student *student) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, student->studentId);
+    pos = journalPutInt(payload, pos, student->penaltyDays);
+    pos = journalPutString(payload, pos, student->studentName);
+    journalAppend(JOURNAL_STUDENT_PUT, payload, pos);
+}
+
+void journalLoanAdd(const BookLoan *loan) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, loan->loanId);
+    pos = journalPutInt(payload, pos, loan->studentId);
+    pos = journalPutInt(payload, pos, loan->bookId);
+    pos = journalPutInt(payload, pos, loan->exampleId);
+    pos = journalPutInt(payload, pos, loan->loanDay);
+    pos = journalPutInt(payload, pos, loan->returnDay);
+    journalAppend(JOURNAL_LOAN_ADD, payload, pos);
+}
+
+void journalLoanReturn(int loanId, int32_t day) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, loanId);
+    pos = journalPutInt(payload, pos, day);
+    journalAppend(JOURNAL_LOAN_RETURN, payload, pos);
+}
+
+void journalPenaltyTick(int32_t day) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, day);
+    journalAppend(JOURNAL_PENALTY_TICK, payload, pos);
+}
+
+void journalLinkAdd(int bookId, int authorId) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, bookId);
+    pos = journalPutInt(payload, pos, authorId);
+    journalAppend(JOURNAL_LINK_ADD, payload, pos);
+}
+
+// Log the deletion of a book, author or student by ID
+void journalDelete(int type, int id) {
+    unsigned char payload[JOURNAL_MAX_PAYLOAD];
+    size_t pos = journalPutInt(payload, 0, id);
+    journalAppend(type, payload, pos);
+}
+
+// Payload decoding helpers; each returns -1 when the payload runs out
+static int journalGetInt(const unsigned char *payload, size_t length, size_t *pos, int *value) {
+    int32_t v;
+    if (*pos + sizeof(v) > length) {
+        return -1;
+    }
+    memcpy(&v, payload + *pos, sizeof(v));
+    *pos += sizeof(v);
+    *value = v;
+    return 0;
+}
+
+static int journalGetString(const unsigned char *payload, size_t length, size_t *pos, char *text, size_t size) {
+    if (*pos >= length) {
+        return -1;
+    }
+    size_t textLength = payload[*pos];
+    if (*pos + 1 + textLength > length || textLength >= size) {
+        return -1;
+    }
+    memcpy(text, payload + *pos + 1, textLength);
+    text[textLength] = '\0';
+    *pos += 1 + textLength;
+    return 0;
+}
+
+// Apply one journal record to the tables. Runs of delete records are
+// collected in deletes and applied as one batch when another record comes
+// or the caller runs it. Returns 0 on success, -1 if the payload does not
+// decode.
+int journalApply(int type, const unsigned char *payload, size_t length,
+                 Book **bookHead, Author **authorHead, Student **studentHead,
+                 BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount,
+                 DeleteBatch *deletes) {
+    size_t pos = 0;
+    int id, a, b, c, d, e;
+    char name[MAX_NAME_LEN], ISBN[MAX_ISBN_LEN];
+
+    if (type != JOURNAL_BOOK_DELETE && type != JOURNAL_AUTHOR_DELETE && type != JOURNAL_STUDENT_DELETE) {
+        deleteBatchRun(deletes, bookHead, authorHead, studentHead, bookAuthorArray, bookAuthorCount);
+    }
+
+    switch (type) {
+        case JOURNAL_BOOK_PUT:
+            if (journalGetInt(payload, length, &pos, &id) || journalGetInt(payload, length, &pos, &a) ||
+                journalGetString(payload, length, &pos, name, sizeof(name)) ||
+                journalGetString(payload, length, &pos, ISBN, sizeof(ISBN))) {
+                return -1;
+            }
+            if (findBookById(*bookHead, id)) {
+                setBookDetails(*bookHead, id, name, ISBN);
+            } else {
+                insertBook(bookHead, id, name, ISBN, a, NULL);
+            }
+            return 0;
+        case JOURNAL_AUTHOR_PUT:
+            if (journalGetInt(payload, length, &pos, &id) ||
+                journalGetString(payload, length, &pos, name, sizeof(name))) {
+                return -1;
+            }
+            if (findAuthorById(*authorHead, id)) {
+                setAuthorName(*authorHead, id, name);
+            } else {
+                insertAuthor(authorHead, id, name, NULL);
+            }
+            return 0;
+        case JOURNAL_STUDENT_PUT:
+            if (journalGetInt(payload, length, &pos, &id) || journalGetInt(payload, length, &pos, &a) ||
+                journalGetString(payload, length, &pos, name, sizeof(name))) {
+                return -1;
+            }
+            Student *student = findStudentById(*studentHead, id);
+            if (student) {
+                setStudentName(*studentHead, id, name);
+                setStudentPenalty(student, a);
+            } else {
+                insertStudent(studentHead, id, name, a, NULL);
+            }
+            return 0;
+        case JOURNAL_BOOK_DELETE:
+        case JOURNAL_AUTHOR_DELETE:
+        case JOURNAL_STUDENT_DELETE:
+            if (journalGetInt(payload, length, &pos, &id)) {
+                return -1;
+            }
+            if (type == JOURNAL_BOOK_DELETE) {
+                deleteBatchAdd(deletes, TABLE_BOOKS, id);
+            } else if (type == JOURNAL_AUTHOR_DELETE) {
+                deleteBatchAdd(deletes, TABLE_AUTHORS, id);
+            } else {
+                deleteBatchAdd(deletes, TABLE_STUDENTS, id);
+            }
+            return 0;
+        case JOURNAL_LOAN_ADD:
+            if (journalGetInt(payload, length, &pos, &id) || journalGetInt(payload, length, &pos, &a) ||
+                journalGetInt(payload, length, &pos, &b) || journalGetInt(payload, length, &pos, &c) ||
+                journalGetInt(payload, length, &pos, &d) || journalGetInt(payload, length, &pos, &e)) {
+                return -1;
+            }
+            if (!hashIndexGet(&loanIdIndex, (uint32_t)id)) {
+                insertLoan(loanHead, *bookHead, id, a, b, c, d, e, NULL);
+            }
+            return 0;
+        case JOURNAL_LOAN_RETURN:
+            if (journalGetInt(payload, length, &pos, &id)) {
+                return -1;
+            }
+            // Records written before returns were charged carry no day
+            a = lastPenaltyDay;
+            if (pos < length && journalGetInt(payload, length, &pos, &a)) {
+                return -1;
+            }
+            closeLoan(*bookHead, id, a);
+            return 0;
+        case JOURNAL_PENALTY_TICK:
+            if (journalGetInt(payload, length, &pos, &a)) {
+                return -1;
+            }
+            runPenaltyTick(a);
+            return 0;
+        case JOURNAL_LINK_ADD:
+            if (journalGetInt(payload, length, &pos, &a) || journalGetInt(payload, length, &pos, &b)) {
+                return -1;
+            }
+            addBookAuthor(bookAuthorArray, bookAuthorCount, a, b);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+// Replay the journal on top of the loaded tables, then open it for
+// appending. A torn or corrupt tail is reported and cut off.
+void journalReplay(Book **bookHead, Author **authorHead, Student **studentHead,
+                   BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    CsvReader mapping; // Only used for its read-only file mapping
+    if (csvOpen(&mapping, JOURNAL_FILE) == 0) {
+        const unsigned char *data = (const unsigned char *)mapping.data;
+        size_t size = mapping.size;
+        size_t pos = JOURNAL_HEADER_SIZE;
+        int applied = 0;
+        DeleteBatch deletes = { 0 };
+
+        if (size > 0 && (size < JOURNAL_HEADER_SIZE || memcmp(data, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE) != 0)) {
+            fprintf(stderr, JOURNAL_FILE ": not a journal file, ignored\n");
+            pos = size = 0;
+        }
+
+        journal.replaying = 1;
+        while (pos + 7 <= size) {
+            uint32_t crc;
+            uint16_t length;
+            memcpy(&crc, data + pos, sizeof(crc));
+            memcpy(&length, data + pos + 4, sizeof(length));
+            if (pos + 7 + length > size || crc32c(data + pos + 4, 3 + (size_t)length) != crc ||
+                journalApply(data[pos + 6], data + pos + 7, length, bookHead, authorHead, studentHead,
+                             loanHead, bookAuthorArray, bookAuthorCount, &deletes) != 0) {
+                break;
+            }
+            pos += 7 + (size_t)length;
+            applied++;
+        }
+        deleteBatchRun(&deletes, bookHead, authorHead, studentHead, bookAuthorArray, bookAuthorCount);
+        journal.replaying = 0;
+
+        if (applied > 0) {
+            fprintf(stderr, "Recovered %d change(s) from " JOURNAL_FILE ".\n", applied);
+        }
+        if (size > 0 && pos < size) {
+            fprintf(stderr, JOURNAL_FILE ": discarded %zu byte(s) of incomplete or corrupt records\n", size - pos);
+            if (truncate(JOURNAL_FILE, (off_t)pos) != 0) {
+                perror("Error truncating " JOURNAL_FILE);
+            }
+        }
+        csvClose(&mapping);
+    }
+
+    if (journalOpen() == 0) {
+        struct stat st;
+        if (fstat(journal.fd, &st) == 0 && st.st_size > JOURNAL_HEADER_SIZE) {
+            journal.fileSize = (size_t)st.st_size - JOURNAL_HEADER_SIZE;
+        }
+    }
+}
+
+// Thread entry: save the table of one SaveJob to its CSV file
+void *saveTableThread(void *arg) {
+    SaveJob *job = (SaveJob *)arg;
+    switch (job->table) {
+        case TABLE_BOOKS: job->status = saveBooks(job->bookHead); break;
+        case TABLE_AUTHORS: job->status = saveAuthors(job->authorHead); break;
+        case TABLE_STUDENTS: job->status = saveStudents(job->studentHead); break;
+        case TABLE_LOANS: job->status = saveBookLoans(job->loanHead); break;
+        case TABLE_LINKS: job->status = saveBookAuthors(job->bookAuthorArray, job->bookAuthorCount); break;
+    }
+    return NULL;
+}
+
+// Write the changed tables to their CSV files and the snapshot, then empty
+// the journal. A CSV file that is missing is written even if its table is
+// unchanged. If a file cannot be written, the journal is kept, so nothing
+// is lost and the next checkpoint tries again. Run at exit and whenever
+// the journal has grown large. Old returned loans are moved to the
+// archive first, so *loanHead may change.
+void checkpointTables(Book *bookHead, Author *authorHead, Student *studentHead,
+                      BookLoan **loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount) {
+    journalCommit(1);
+
+    size_t archived = archiveOldLoans(loanHead, currentDay());
+    if (archived > 0) {
+        fprintf(stderr, "Archived %zu returned loan(s) in " ARCHIVE_DIR "/.\n", archived);
+    }
+
+    unsigned saving = csvDirtyTables;
+    if (access("kitaplar.csv", F_OK) != 0) {
+        saving |= TABLE_BOOKS;
+    }
+    if (access("yazarlar.csv", F_OK) != 0) {
+        saving |= TABLE_AUTHORS;
+    }
+    if (access("ogrenciler.csv", F_OK) != 0) {
+        saving |= TABLE_STUDENTS;
+    }
+    if (access("kitap_odunc.csv", F_OK) != 0) {
+        saving |= TABLE_LOANS;
+    }
+    if (access("kitap_yazar.csv", F_OK) != 0) {
+        saving |= TABLE_LINKS;
+    }
+
+    // Save the tables concurrently, one thread each
+    static const unsigned tables[] = { TABLE_BOOKS, TABLE_AUTHORS, TABLE_STUDENTS, TABLE_LOANS, TABLE_LINKS };
+    static const char *fileNames[] = { "kitaplar.csv", "yazarlar.csv", "ogrenciler.csv", "kitap_odunc.csv", "kitap_yazar.csv" };
+    SaveJob jobs[5];
+    pthread_t threads[5];
+    int started[5] = { 0 };
+    struct timespec startTime, endTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    for (int i = 0; i < 5; i++) {
+        SaveJob job = { tables[i], fileNames[i], bookHead, authorHead, studentHead,
+                        *loanHead, bookAuthorArray, bookAuthorCount, -1 };
+        jobs[i] = job;
+        if (!(saving & tables[i])) {
+            continue;
+        }
+        // Keep a file whose malformed lines were skipped before dropping them
+        if ((csvSkippedTables & tables[i]) && keepBackup(fileNames[i]) != 0) {
+            continue;
+        }
+        started[i] = pthread_create(&threads[i], NULL, saveTableThread, &jobs[i]) == 0;
+        if (!started[i]) {
+            saveTableThread(&jobs[i]);
+        }
+    }
+
+    unsigned saved = 0;
+    double megabytes = 0;
+    for (int i = 0; i < 5; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        struct stat st;
+        if ((saving & tables[i]) && jobs[i].status == 0) {
+            saved |= tables[i];
+            if (stat(fileNames[i], &st) == 0) {
+                megabytes += st.st_size / (1024.0 * 1024.0);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    double seconds = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+    if (saved != 0) {
+        fprintf(stderr, "Saved %.1f MB of CSV in %.2f s (%.0f MB/s).\n", megabytes, seconds,
+                seconds > 0 ? megabytes / seconds : 0.0);
+    }
+    csvDirtyTables &= ~saved;
+    csvSkippedTables &= ~saved;
+    int failed = saved != saving;
+    if (saving != 0 || access("sayaclar.csv", F_OK) != 0) {
+        failed |= saveSequences() != 0;
+    }
+
+    // The snapshot goes last, so that it is newer than the CSV files. It
+    // is skipped after a CSV error: the CSV files are then newer and get
+    // imported on the next start, with the journal replayed on top.
+    if (!failed && (snapshotDirtyTables != 0 || saving != 0 || !snapshotIsCurrent())) {
+        failed = saveSnapshot(bookHead, authorHead, studentHead, *loanHead, bookAuthorArray, bookAuthorCount) != 0;
+    }
+    syncDirectory();
+    if (!failed) {
+        journalTruncate();
+    }
+}
+
+
+
+// --- Startup Functions ---
+// The tables are loaded concurrently, one thread each. A loader only
+// touches its own table: its node pool, ID and name indexes, list tail and
+// ID sequence, and for the loans also the loan indexes and the due heap.
+// Everything that relates one table to another (which copies are on loan,
+// whether loans and links point at existing rows) is done afterwards by
+// linkTables, once all tables are in memory.
+
+#define LINK_MAX_REPORTED 10 // Dangling references reported before only counting
+
+// Thread entry: load the table of one LoadJob from the snapshot or its CSV file
+void *loadTableThread(void *arg) {
+    LoadJob *job = (LoadJob *)arg;
+    const SnapshotView *snapshot = job->snapshot;
+    switch (job->table) {
+        case TABLE_BOOKS:
+            if (snapshot) {
+                snapshotLoadBooks(snapshot, job->bookHead);
+            } else {
+                loadBooks(job->bookHead);
+            }
+            break;
+        case TABLE_AUTHORS:
+            if (snapshot) {
+                snapshotLoadAuthors(snapshot, job->authorHead);
+            } else {
+                loadAuthors(job->authorHead);
+            }
+            break;
+        case TABLE_STUDENTS:
+            if (snapshot) {
+                snapshotLoadStudents(snapshot, job->studentHead);
+            } else {
+                loadStudents(job->studentHead);
+            }
+            break;
+        case TABLE_LOANS:
+            if (snapshot) {
+                snapshotLoadLoans(snapshot, job->loanHead);
+            } else {
+                loadBookLoans(job->loanHead);
+            }
+            break;
+        case TABLE_LINKS:
+            if (snapshot) {
+                snapshotLoadLinks(snapshot, job->bookAuthorArray, job->bookAuthorCount);
+            } else {
+                loadBookAuthors(job->bookAuthorArray, job->bookAuthorCount);
+            }
+            break;
+    }
+    return NULL;
+}
+
+// Load all tables concurrently from a validated snapshot, or from the CSV
+// files when snapshot is NULL, and wait for all of them. A table whose
+// thread cannot be started is loaded on the calling thread.
+void loadTables(const SnapshotView *snapshot, Book **bookHead, Author **authorHead, Student **studentHead,
+                BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    static const unsigned tables[] = { TABLE_BOOKS, TABLE_AUTHORS, TABLE_STUDENTS, TABLE_LOANS, TABLE_LINKS };
+    LoadJob jobs[5];
+    pthread_t threads[5];
+    int started[5] = { 0 };
+    for (int i = 0; i < 5; i++) {
+        LoadJob job = { tables[i], snapshot, bookHead, authorHead, studentHead,
+                        loanHead, bookAuthorArray, bookAuthorCount };
+        jobs[i] = job;
+        started[i] = pthread_create(&threads[i], NULL, loadTableThread, &jobs[i]) == 0;
+        if (!started[i]) {
+            loadTableThread(&jobs[i]);
+        }
+    }
+    for (int i = 0; i < 5; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+// Derive which copies are on loan from the active loans and check the
+// references between the loaded tables. Loans and links that point at a
+// missing row are reported on stderr but kept, so that nothing is lost
+// when the tables are saved again. Run once after loadTables, before the
+// journal is replayed.
+void linkTables(Book *bookHead, BookAuthor *bookAuthorArray, int bookAuthorCount) {
+    for (Book *book = bookHead; book != NULL; book = book->next) {
+        memset(bookExampleWords(book), 0, sizeof(uint64_t) * ((book->exampleCount + 63) / 64));
+        book->availableCount = book->exampleCount;
+    }
+
+    int dangling = 0;
+    for (size_t i = 0; i < dueHeap.count; i++) {
+        BookLoan *loan = dueHeap.loans[i];
+        Book *book = (Book *)hashIndexGet(&bookIdIndex, (uint32_t)loan->bookId);
+        const char *problem = NULL;
+        if (!book) {
+            problem = "book does not exist";
+        } else if (getBookExampleStatus(book, loan->exampleId) < 0) {
+            problem = "book example does not exist";
+        } else if (getBookExampleStatus(book, loan->exampleId) == 1) {
+            problem = "book example is already on loan";
+        } else {
+            int bit = loan->exampleId - 1;
+            bookExampleWords(book)[bit / 64] |= 1ULL << (bit % 64);
+            book->availableCount--;
+            if (!hashIndexGet(&studentIdIndex, (uint32_t)loan->studentId)) {
+                problem = "student does not exist";
+            }
+        }
+        if (problem && ++dangling <= LINK_MAX_REPORTED) {
+            fprintf(stderr, "kitap_odunc.csv: active loan %d: %s\n", loan->loanId, problem);
+        }
+    }
+
+    for (int i = 0; i < bookAuthorCount; i++) {
+        const char *problem = NULL;
+        if (!hashIndexGet(&bookIdIndex, (uint32_t)bookAuthorArray[i].bookId)) {
+            problem = "book does not exist";
+        } else if (!hashIndexGet(&authorIdIndex, (uint32_t)bookAuthorArray[i].authorId)) {
+            problem = "author does not exist";
+        }
+        if (problem && ++dangling <= LINK_MAX_REPORTED) {
+            fprintf(stderr, "kitap_yazar.csv: link %d,%d: %s\n",
+                    bookAuthorArray[i].bookId, bookAuthorArray[i].authorId, problem);
+        }
+    }
+    if (dangling > LINK_MAX_REPORTED) {
+        fprintf(stderr, "%d more dangling references not shown\n", dangling - LINK_MAX_REPORTED);
+    }
+}
+
+// Hold an exclusive lock on kutuphane.lock until the process exits, so
+// that a second copy cannot load the same files and overwrite the first
+// copy's changes when it saves. Returns -1 if another process holds it.
+int lockDataFiles() {
+    int fd = open(LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("Error opening " LOCK_FILE);
+        return 0;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno == EWOULDBLOCK) {
+            fprintf(stderr, "The data files are in use by another copy of the program. "
+                            "Connect to it with library_client if it was started with --serve.\n");
+            close(fd);
+            return -1;
+        }
+        perror("Error locking " LOCK_FILE);
+    }
+    return 0; // fd stays open: the lock is released when the process exits
+}
+
+// Save the tables, close the journal and free everything. Called once,
+// when the menu or a batch run ends.
+void closeLibrary(Book *bookHead, Author *authorHead, Student *studentHead,
+                  BookLoan *loanHead, BookAuthor *bookAuthorArray, int bookAuthorCount) {
+    checkpointTables(bookHead, authorHead, studentHead, &loanHead, bookAuthorArray, bookAuthorCount);
+    journalClose();
+
+    // Free allocated memory
+    freeBooks(bookHead);
+    freeAuthors(authorHead);
+    freeStudents(studentHead);
+    freeBookLoans(loanHead);
+    free(bookAuthorArray); // Free the dynamic array
+    resetBookAuthorIndexes(0);
+    hashIndexFree(&bookIdIndex);
+    hashIndexFree(&authorIdIndex);
+    hashIndexFree(&studentIdIndex);
+    hashIndexFree(&loanIdIndex);
+    hashIndexFree(&isbnIndex);
+    nameIndexFree(&bookNameIndex);
+    nameIndexFree(&authorNameIndex);
+    nameIndexFree(&studentNameIndex);
+    wordIndexFree(&bookWordIndex);
+    wordIndexFree(&authorWordIndex);
+    trigramIndexFree(&bookTrigramIndex);
+    trigramIndexFree(&authorTrigramIndex);
+    trigramIndexFree(&studentTrigramIndex);
+    hashIndexFree(&studentLoanIndex);
+    hashIndexFree(&exampleLoanIndex);
+    poolDestroy(&loanChainPool);
+    loanHeapFree(&dueHeap);
+}
+
+
+// --- Table Lock Functions ---
+// Every table has a reader-writer lock. Code that uses the tables from
+// several threads (the server workers) holds the locks of all tables an
+// operation reads or changes for the whole operation, taken at once with
+// lockTables. Single-threaded code (startup, the menu, batch mode) does
+// not lock.
+//
+// Lock order: books, authors, students, loans, links, which is the order
+// of the TABLE_* bits. lockTables always acquires in that order, so
+// operations spanning several tables cannot deadlock. loanInsertLock and
+// then journalLock are taken inside the table locks and never the other
+// way round.
+//
+// What each lock covers:
+//   books     book rows, the ID, ISBN and name indexes, bookPool, nextBookId
+//   authors   author rows and indexes, authorPool, nextAuthorId
+//   students  student rows and indexes, studentPool, nextStudentId
+//   loans     loan rows, loan indexes, due heap, nextLoanId; a borrow adds
+//             a loan under a read lock, holding loanInsertLock while it
+//             records it, and readers that may run beside a borrow (the
+//             active loan count) take loanInsertLock too
+// Which copies of a book are on loan (example bits and availableCount) is
+// not covered by a lock: claimBookExample and releaseBookExample change it
+// atomically, so lending and returning need only a read lock on books.
+//   links     the book-author array, its capacity and linkSet; the CSR
+//             link indexes are rebuilt under linkIndexLock by readers
+// The word indexes belong to books and authors; the first word search
+// builds them under wordIndexLock while holding read locks on both.
+// For example, borrowing reads books, students and loans; returning
+// writes students, since a late return charges a penalty, and loans;
+// deleting a student writes students and reads loans, since a student
+// with active loans cannot be deleted.
+
+// Lock tables for an operation: read locks on readTables and write locks
+// on writeTables (which win when a table is in both), in lock order
+void lockTables(unsigned readTables, unsigned writeTables) {
+    for (int i = 0; i < TABLE_COUNT; i++) {
+        unsigned table = 1u << i;
+        if (writeTables & table) {
+            pthread_rwlock_wrlock(&tableLocks[i]);
+        } else if (readTables & table) {
+            pthread_rwlock_rdlock(&tableLocks[i]);
+        }
+    }
+}
+
+// Release the locks taken by lockTables (pass readTables | writeTables)
+void unlockTables(unsigned tables) {
+    for (int i = TABLE_COUNT - 1; i >= 0; i--) {
+        if (tables & (1u << i)) {
+            pthread_rwlock_unlock(&tableLocks[i]);
+        }
+    }
+}
+
+
+// --- Batch Mode Functions ---
+// `library --batch FILE` (FILE may be - for stdin) runs one command per
+// line without prompts and prints one result line per command:
+//   <line number> OK [values]
+//   <line number> ERROR <status> [detail]
+// Blank lines and lines starting with '#' are skipped. Changes go through
+// the journal like menu changes and the tables are saved once at the end.
+// The exit status is 0 if every command succeeded and 1 otherwise.
+// A name runs to the end of the line; for UPDATE_BOOK, '-' keeps a value.
+//   PING                                         -> OK
+//   BOOK <bookId>               -> OK <available> <exampleCount> <ISBN> <name>
+//   STUDENT <studentId>         -> OK <penaltyDays> <activeLoans> <name>
+//   SEARCH_BOOKS <name prefix>  -> OK <matches> <bookId>... (first 20)
+//   SEARCH <words>              -> OK <matches> <bookId>... (best 20)
+//   SIMILAR <BOOKS|AUTHORS|STUDENTS> <name>      -> OK <count> <id>... (best 20)
+//   BOOK_AUTHORS <bookId>       -> OK <count> <authorId>... (first 20)
+//   AUTHOR_BOOKS <authorId>     -> OK <count> <bookId>... (first 20)
+//   ADD_BOOK <exampleCount> <ISBN> <name>       -> OK <bookId>
+//   UPDATE_BOOK <bookId> <ISBN|-> <name|->
+//   DELETE_BOOK <bookId>
+//   ADD_AUTHOR <name>                            -> OK <authorId>
+//   RENAME_AUTHOR <authorId> <name>
+//   DELETE_AUTHOR <authorId>
+//   ADD_STUDENT <studentId, 0 for next> <name>   -> OK <studentId>
+//   RENAME_STUDENT <studentId> <name>
+//   DELETE_STUDENT <studentId>
+//   DELETE_MANY [BOOKS <ids>] [AUTHORS <ids>] [STUDENTS <ids>]
+//       -> OK <books> <authors> <students> <links> <inUse> <notFound>
+//       (ids are IDs or ranges first-last; rows with active loans are kept)
+//   BORROW <studentId> <bookId> [exampleId]      -> OK <loanId> <exampleId>
+//   RETURN <loanId>
+//   LINK <bookId> <authorId>
+
+// Next space-separated word of a command line, or NULL at its end
+char *batchWord(char **cursor) {
+    char *p = *cursor + strspn(*cursor, " \t");
+    if (*p == '\0') {
+        *cursor = p;
+        return NULL;
+    }
+    char *word = p;
+    p += strcspn(p, " \t");
+    if (*p != '\0') {
+        *p++ = '\0';
+    }
+    *cursor = p;
+    return word;
+}
+
+// Rest of a command line without surrounding blanks (may be empty)
+char *batchRest(char **cursor) {
+    char *text = *cursor + strspn(*cursor, " \t");
+    size_t length = strlen(text);
+    while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t')) {
+        text[--length] = '\0';
+    }
+    *cursor = text + length;
+    return text;
+}
+
+// Parse the next word as an integer. Returns 1 on success.
+int batchInt(char **cursor, int *value) {
+    char *word = batchWord(cursor);
+    return word != NULL && csvParseInt(word, strlen(word), value) == 0;
+}
+
+// Parse an ID or an ID range <first>-<last> of at most BULK_MAX_RANGE IDs.
+// Returns 1 on success.
+int batchIdRange(const char *word, int *first, int *last) {
+    const char *dash = strchr(word + 1, '-');
+    if (!dash) {
+        if (csvParseInt(word, strlen(word), first) != 0) {
+            return 0;
+        }
+        *last = *first;
+        return 1;
+    }
+    return csvParseInt(word, (size_t)(dash - word), first) == 0 &&
+           csvParseInt(dash + 1, strlen(dash + 1), last) == 0 &&
+           *first <= *last && (int64_t)*last - *first < BULK_MAX_RANGE;
+}
+
+// Check that a name or ISBN fits its field. Returns 1 if it does.
+int batchText(const char *text, size_t size) {
+    return text != NULL && strlen(text) < size;
+}
+
+// Record why a command could not be parsed and return OP_BAD_REQUEST
+int batchBadRequest(char *detail, size_t detailSize, const char *reason) {
+    snprintf(detail, detailSize, "%s", reason);
+    return OP_BAD_REQUEST;
+}
+
+// Run one batch command. Returns the OP_* status; detail receives the
+// values printed after OK, or what was not found or could not be parsed.
+int runBatchCommand(char *line, char *detail, size_t detailSize, Book **bookHead, Author **authorHead,
+                    Student **studentHead, BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    char *cursor = line;
+    char *command = batchWord(&cursor);
+    int id, otherId;
+    detail[0] = '\0';
+
+    if (!command) {
+        return batchBadRequest(detail, detailSize, "empty command");
+    }
+    if (strcmp(command, "PING") == 0) {
+        return OP_OK;
+    }
+    if (strcmp(command, "BOOK") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <bookId>");
+        }
+        Book *book = findBookById(*bookHead, id);
+        if (!book) {
+            return OP_NOT_FOUND;
+        }
+        snprintf(detail, detailSize, "%d %d %s %s", __atomic_load_n(&book->availableCount, __ATOMIC_RELAXED),
+                 book->exampleCount, book->ISBN, book->bookName);
+        return OP_OK;
+    }
+    if (strcmp(command, "STUDENT") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <studentId>");
+        }
+        Student *student = findStudentById(*studentHead, id);
+        if (!student) {
+            return OP_NOT_FOUND;
+        }
+        snprintf(detail, detailSize, "%d %d %s", student->penaltyDays,
+                 getLoanCountForStudent(*loanHead, id), student->studentName);
+        return OP_OK;
+    }
+    if (strcmp(command, "SEARCH_BOOKS") == 0) {
+        char *prefix = batchRest(&cursor);
+        if (prefix[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <name prefix>");
+        }
+        Book *matches[MAX_SEARCH_RESULTS];
+        size_t total = findBooksByNamePrefix(prefix, matches, MAX_SEARCH_RESULTS);
+        size_t length = (size_t)snprintf(detail, detailSize, "%zu", total);
+        for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS && length < detailSize; i++) {
+            length += (size_t)snprintf(detail + length, detailSize - length, " %d", matches[i]->bookId);
+        }
+        return OP_OK;
+    }
+    if (strcmp(command, "SEARCH") == 0) {
+        char *query = batchRest(&cursor);
+        if (query[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <words>");
+        }
+        int ids[MAX_SEARCH_RESULTS];
+        size_t total = findBooksByWords(query, *bookHead, *authorHead, *bookAuthorArray, *bookAuthorCount,
+                                        ids, MAX_SEARCH_RESULTS);
+        size_t length = (size_t)snprintf(detail, detailSize, "%zu", total);
+        for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS && length < detailSize; i++) {
+            length += (size_t)snprintf(detail + length, detailSize - length, " %d", ids[i]);
+        }
+        return OP_OK;
+    }
+    if (strcmp(command, "SIMILAR") == 0) {
+        char *table = batchWord(&cursor);
+        char *name = batchRest(&cursor);
+        if (!table || name[0] == '\0' ||
+            (strcmp(table, "BOOKS") != 0 && strcmp(table, "AUTHORS") != 0 && strcmp(table, "STUDENTS") != 0)) {
+            return batchBadRequest(detail, detailSize, "expected <BOOKS|AUTHORS|STUDENTS> <name>");
+        }
+        int ids[MAX_SEARCH_RESULTS];
+        size_t total = strcmp(table, "BOOKS") == 0 ? findBooksBySimilarName(name, ids, MAX_SEARCH_RESULTS)
+                     : strcmp(table, "AUTHORS") == 0 ? findAuthorsBySimilarName(name, ids, MAX_SEARCH_RESULTS)
+                     : findStudentsBySimilarName(name, ids, MAX_SEARCH_RESULTS);
+        size_t length = (size_t)snprintf(detail, detailSize, "%zu", total);
+        for (size_t i = 0; i < total && i < MAX_SEARCH_RESULTS && length < detailSize; i++) {
+            length += (size_t)snprintf(detail + length, detailSize - length, " %d", ids[i]);
+        }
+        return OP_OK;
+    }
+    if (strcmp(command, "BOOK_AUTHORS") == 0 || strcmp(command, "AUTHOR_BOOKS") == 0) {
+        int ofBook = strcmp(command, "BOOK_AUTHORS") == 0;
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, ofBook ? "expected <bookId>" : "expected <authorId>");
+        }
+        int ids[MAX_SEARCH_RESULTS];
+        int count = ofBook ? getAuthorsOfBook(*bookAuthorArray, *bookAuthorCount, id, ids, MAX_SEARCH_RESULTS)
+                           : getBooksByAuthor(*bookAuthorArray, *bookAuthorCount, id, ids, MAX_SEARCH_RESULTS);
+        size_t length = (size_t)snprintf(detail, detailSize, "%d", count);
+        for (int i = 0; i < count && i < MAX_SEARCH_RESULTS && length < detailSize; i++) {
+            length += (size_t)snprintf(detail + length, detailSize - length, " %d", ids[i]);
+        }
+        return OP_OK;
+    }
+    if (strcmp(command, "ADD_BOOK") == 0) {
+        int exampleCount;
+        if (!batchInt(&cursor, &exampleCount) || exampleCount < 0) {
+            return batchBadRequest(detail, detailSize, "expected <exampleCount> <ISBN> <name>");
+        }
+        char *ISBN = batchWord(&cursor);
+        char *bookName = batchRest(&cursor);
+        if (!batchText(ISBN, MAX_ISBN_LEN) || !isbnStorable(ISBN) ||
+            !batchText(bookName, MAX_NAME_LEN) || bookName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <exampleCount> <ISBN> <name>");
+        }
+        Book *book;
+        int status = insertBook(bookHead, 0, bookName, ISBN, exampleCount, &book);
+        if (status == OP_OK) {
+            snprintf(detail, detailSize, "%d", book->bookId);
+        }
+        return status;
+    }
+    if (strcmp(command, "UPDATE_BOOK") == 0) {
+        if (!batchInt(&cursor, &id)) {
+            return batchBadRequest(detail, detailSize, "expected <bookId> <ISBN|-> <name|->");
+        }
+        char *ISBN = batchWord(&cursor);
+        char *bookName = batchRest(&cursor);
+        if (!batchText(ISBN, MAX_ISBN_LEN) || !isbnStorable(ISBN) ||
+            !batchText(bookName, MAX_NAME_LEN) || bookName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <bookId> <ISBN|-> <name|->");
+        }
+        return setBookDetails(*bookHead, id, strcmp(bookName, "-") == 0 ? "" : bookName,
+                              strcmp(ISBN, "-") == 0 ? "" : ISBN);
+    }
+    if (strcmp(command, "DELETE_BOOK") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <bookId>");
+        }
+        return removeBook(bookHead, bookAuthorArray, bookAuthorCount, id);
+    }
+    if (strcmp(command, "ADD_AUTHOR") == 0) {
+        char *authorName = batchRest(&cursor);
+        if (!batchText(authorName, MAX_NAME_LEN) || authorName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <name>");
+        }
+        Author *author;
+        int status = insertAuthor(authorHead, 0, authorName, &author);
+        if (status == OP_OK) {
+            snprintf(detail, detailSize, "%d", author->authorId);
+        }
+        return status;
+    }
+    if (strcmp(command, "RENAME_AUTHOR") == 0) {
+        char *authorName = NULL;
+        if (batchInt(&cursor, &id)) {
+            authorName = batchRest(&cursor);
+        }
+        if (!batchText(authorName, MAX_NAME_LEN) || authorName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <authorId> <name>");
+        }
+        return setAuthorName(*authorHead, id, authorName);
+    }
+    if (strcmp(command, "DELETE_AUTHOR") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <authorId>");
+        }
+        return removeAuthor(authorHead, bookAuthorArray, bookAuthorCount, id);
+    }
+    if (strcmp(command, "ADD_STUDENT") == 0) {
+        char *studentName = NULL;
+        if (batchInt(&cursor, &id) && id >= 0) {
+            studentName = batchRest(&cursor);
+        }
+        if (!batchText(studentName, MAX_NAME_LEN) || studentName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <studentId> <name>");
+        }
+        Student *student;
+        int status = insertStudent(studentHead, id, studentName, 0, &student);
+        if (status == OP_OK) {
+            snprintf(detail, detailSize, "%d", student->studentId);
+        }
+        return status;
+    }
+    if (strcmp(command, "RENAME_STUDENT") == 0) {
+        char *studentName = NULL;
+        if (batchInt(&cursor, &id)) {
+            studentName = batchRest(&cursor);
+        }
+        if (!batchText(studentName, MAX_NAME_LEN) || studentName[0] == '\0') {
+            return batchBadRequest(detail, detailSize, "expected <studentId> <name>");
+        }
+        return setStudentName(*studentHead, id, studentName);
+    }
+    if (strcmp(command, "DELETE_STUDENT") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <studentId>");
+        }
+        return removeStudent(studentHead, id);
+    }
+    if (strcmp(command, "DELETE_MANY") == 0) {
+        DeleteBatch batch = { 0 };
+        unsigned table = 0;
+        int inUse = 0, notFound = 0, last;
+        char *word;
+        while ((word = batchWord(&cursor)) != NULL) {
+            if (strcmp(word, "BOOKS") == 0) {
+                table = TABLE_BOOKS;
+            } else if (strcmp(word, "AUTHORS") == 0) {
+                table = TABLE_AUTHORS;
+            } else if (strcmp(word, "STUDENTS") == 0) {
+                table = TABLE_STUDENTS;
+            } else if (table == 0 || !batchIdRange(word, &id, &last)) {
+                deleteBatchFree(&batch);
+                return batchBadRequest(detail, detailSize,
+                                       "expected [BOOKS <ids>] [AUTHORS <ids>] [STUDENTS <ids>]");
+            } else {
+                for (int64_t rowId = id; rowId <= last; rowId++) {
+                    int status = deleteBatchAdd(&batch, table, (int)rowId);
+                    if (status == OP_NO_MEMORY) {
+                        deleteBatchFree(&batch);
+                        return status;
+                    }
+                    inUse += status == OP_IN_USE;
+                    notFound += status == OP_NOT_FOUND;
+                }
+            }
+        }
+        deleteBatchRun(&batch, bookHead, authorHead, studentHead, bookAuthorArray, bookAuthorCount);
+        snprintf(detail, detailSize, "%d %d %d %d %d %d", batch.deletedBooks, batch.deletedAuthors,
+                 batch.deletedStudents, batch.removedLinks, inUse, notFound);
+        return OP_OK;
+    }
+    if (strcmp(command, "BORROW") == 0) {
+        int exampleId = 0;
+        char *exampleWord = NULL;
+        if (!batchInt(&cursor, &id) || !batchInt(&cursor, &otherId) ||
+            ((exampleWord = batchWord(&cursor)) != NULL &&
+             csvParseInt(exampleWord, strlen(exampleWord), &exampleId) != 0) ||
+            batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <studentId> <bookId> [exampleId]");
+        }
+        if (!findStudentById(*studentHead, id)) {
+            snprintf(detail, detailSize, "student");
+            return OP_NOT_FOUND;
+        }
+        int32_t today = currentDay();
+        BookLoan *loan;
+        int status = insertLoan(loanHead, *bookHead, 0, id, otherId, exampleId,
+                                today, today + LOAN_PERIOD_DAYS, &loan);
+        if (status == OP_OK) {
+            snprintf(detail, detailSize, "%d %d", loan->loanId, loan->exampleId);
+        } else if (status == OP_NOT_FOUND) {
+            snprintf(detail, detailSize, "book");
+        }
+        return status;
+    }
+    if (strcmp(command, "RETURN") == 0) {
+        if (!batchInt(&cursor, &id) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <loanId>");
         }
-        newStudent->next = NULL;
-
-        // Parse CSV line: studentId,studentName,penaltyDays
-        sscanf(line, "%d,%[^,],%d", &newStudent->studentId, newStudent->studentName, &newStudent->penaltyDays);
-
-        if (*studentHead == NULL) {
-            *studentHead = newStudent;
-            last = newStudent;
-        } else {
-            last->next = newStudent;
-            last = newStudent;
+        return closeLoan(*bookHead, id, currentDay());
+    }
+    if (strcmp(command, "LINK") == 0) {
+        if (!batchInt(&cursor, &id) || !batchInt(&cursor, &otherId) || batchWord(&cursor)) {
+            return batchBadRequest(detail, detailSize, "expected <bookId> <authorId>");
+        }
+        if (!findBookById(*bookHead, id)) {
+            snprintf(detail, detailSize, "book");
+            return OP_NOT_FOUND;
         }
+        if (!findAuthorById(*authorHead, otherId)) {
+            snprintf(detail, detailSize, "author");
+            return OP_NOT_FOUND;
+        }
+        return addBookAuthor(bookAuthorArray, bookAuthorCount, id, otherId);
     }
-    fclose(file);
+    snprintf(detail, detailSize, "unknown command %s", command);
+    return OP_BAD_REQUEST;
 }
 
-// Save students to CSV
-void saveStudents(Student *studentHead) {
-    FILE *file = fopen("ogrenciler.csv", "w");
-    if (!file) {
-        perror("Error opening ogrenciler.csv for writing");
-        return;
+// Tables a batch command line reads and changes, for lockTables. Unknown
+// commands need no locks, they fail without touching the tables.
+void batchCommandTables(const char *line, unsigned *readTables, unsigned *writeTables) {
+    static const CommandTables commands[] = {
+        { "PING", 0, 0 },
+        { "BOOK", TABLE_BOOKS, 0 },
+        { "STUDENT", TABLE_STUDENTS | TABLE_LOANS, 0 },
+        { "SEARCH_BOOKS", TABLE_BOOKS, 0 },
+        { "SEARCH", TABLE_BOOKS | TABLE_AUTHORS | TABLE_LINKS, 0 },
+        { "SIMILAR", TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS, 0 },
+        { "BOOK_AUTHORS", TABLE_LINKS, 0 },
+        { "AUTHOR_BOOKS", TABLE_LINKS, 0 },
+        { "ADD_BOOK", 0, TABLE_BOOKS },
+        { "UPDATE_BOOK", 0, TABLE_BOOKS },
+        { "DELETE_BOOK", 0, TABLE_BOOKS | TABLE_LINKS },
+        { "ADD_AUTHOR", 0, TABLE_AUTHORS },
+        { "RENAME_AUTHOR", 0, TABLE_AUTHORS },
+        { "DELETE_AUTHOR", 0, TABLE_AUTHORS | TABLE_LINKS },
+        { "ADD_STUDENT", 0, TABLE_STUDENTS },
+        { "RENAME_STUDENT", 0, TABLE_STUDENTS },
+        { "DELETE_STUDENT", TABLE_LOANS, TABLE_STUDENTS },
+        { "DELETE_MANY", TABLE_LOANS, TABLE_BOOKS | TABLE_AUTHORS | TABLE_STUDENTS | TABLE_LINKS },
+        { "BORROW", TABLE_BOOKS | TABLE_STUDENTS | TABLE_LOANS, 0 }, // Records the loan under loanInsertLock
+        { "RETURN", TABLE_BOOKS, TABLE_STUDENTS | TABLE_LOANS },
+        { "LINK", TABLE_BOOKS | TABLE_AUTHORS, TABLE_LINKS }
+    };
+    const char *command = line + strspn(line, " \t");
+    size_t length = strcspn(command, " \t");
+    *readTables = 0;
+    *writeTables = 0;
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strlen(commands[i].command) == length && strncmp(commands[i].command, command, length) == 0) {
+            *readTables = commands[i].readTables;
+            *writeTables = commands[i].writeTables;
+            return;
+        }
     }
+}
 
-    // Write header
-    fprintf(file, "studentId,studentName,penaltyDays\n");
-
-    Student *current = studentHead;
-    while (current != NULL) {
-        fprintf(file, "%d,%s,%d\n", current->studentId, current->studentName, current->penaltyDays);
-        current = current->next;
+// Format the result of a batch command as "OK [values]" or
+// "ERROR <status> [detail]". Returns the length, truncated to fit size.
+size_t formatBatchResult(char *result, size_t size, int status, const char *detail) {
+    static const char *statusNames[] = {
+        "OK", "NOT_FOUND", "DUPLICATE", "IN_USE", "UNAVAILABLE", "RETURNED", "NO_MEMORY", "BAD_REQUEST"
+    };
+    int length;
+    if (status == OP_OK) {
+        length = snprintf(result, size, "OK%s%s", detail[0] ? " " : "", detail);
+    } else {
+        length = snprintf(result, size, "ERROR %s%s%s", statusNames[status], detail[0] ? " " : "", detail);
     }
-    fclose(file);
+    if (length < 0) {
+        return 0;
+    }
+    return (size_t)length < size ? (size_t)length : size - 1;
 }
 
-// Add a new student
-void addStudent(Student **studentHead) {
-    Student *newStudent = (Student *)malloc(sizeof(Student));
-    if (!newStudent) {
-        perror("Memory allocation failed");
-        return;
+// Run the commands of a batch file (or stdin for "-") and print one
+// result line per command. Returns the process exit status.
+int runBatch(const char *fileName, Book **bookHead, Author **authorHead, Student **studentHead,
+             BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    FILE *input = strcmp(fileName, "-") == 0 ? stdin : fopen(fileName, "r");
+    if (!input) {
+        perror("Error opening batch file");
+        return 2;
     }
-    newStudent->next = NULL;
 
-    // Find the next available student ID
-    int maxStudentId = 0;
-    Student *current = *studentHead;
-    while (current != NULL) {
-        if (current->studentId > maxStudentId) {
-            maxStudentId = current->studentId;
+    struct timespec startTime, endTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    char *line = NULL;
+    size_t capacity = 0;
+    long lineNumber = 0;
+    long commands = 0;
+    long failed = 0;
+    while (getline(&line, &capacity, input) != -1) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *command = line + strspn(line, " \t");
+        if (*command == '\0' || *command == '#') {
+            continue;
         }
-        current = current->next;
-    }
-    newStudent->studentId = maxStudentId + 1;
 
-    printf("Enter Student Name: ");
-    fgets(newStudent->studentName, sizeof(newStudent->studentName), stdin);
-    newStudent->studentName[strcspn(newStudent->studentName, "\n")] = 0; 
+        if (penaltyTickDue()) {
+            runPenaltyTick(currentDay());
+        }
 
-    newStudent->penaltyDays = 0; // New student starts with 0 penalty days
+        char detail[MAX_LINE_LEN];
+        char result[SERVER_MAX_RESPONSE];
+        int status = runBatchCommand(command, detail, sizeof(detail), bookHead, authorHead,
+                                     studentHead, loanHead, bookAuthorArray, bookAuthorCount);
+        formatBatchResult(result, sizeof(result), status, detail);
+        printf("%ld %s\n", lineNumber, result);
+        commands++;
+        if (status != OP_OK) {
+            failed++;
+        }
 
-    // Add to the end of the list
-    if (*studentHead == NULL) {
-        *studentHead = newStudent;
-    } else {
-        current = *studentHead;
-        while (current->next != NULL) {
-            current = current->next;
+        journalCommit(0);
+        if (journalCheckpointDue()) {
+            checkpointTables(*bookHead, *authorHead, *studentHead, loanHead, *bookAuthorArray, *bookAuthorCount);
         }
-        current->next = newStudent;
     }
+    free(line);
+    if (input != stdin) {
+        fclose(input);
+    }
+    fflush(stdout);
 
-    printf("Student added successfully with ID %d.\n", newStudent->studentId);
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    double seconds = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+    fprintf(stderr, "Batch: %ld command(s), %ld failed, %.2f s\n", commands, failed, seconds);
+    return failed ? 1 : 0;
 }
 
-// Delete a student by ID
-void deleteStudentById(Student **studentHead, BookLoan *loanHead) {
-    int studentId;
-    printf("Enter Student ID to delete: ");
-    scanf("%d", &studentId);
-    getchar(); 
 
-    // Check if the student has any active loans
-    if (getLoanCountForStudent(loanHead, studentId) > 0) {
-        printf("Cannot delete student with active book loans.\n");
-        return;
-    }
+// --- Server Functions ---
+// `library --serve [SOCKET]` keeps the tables in memory and serves the
+// batch commands to any number of clients over a Unix domain socket
+// (kutuphane.sock by default). Requests and responses are framed the
+// same way: a 4-byte big-endian payload length, then the payload. A
+// request payload is one batch command; the response payload is its
+// result line without the line number, e.g. "OK 1042 2" or
+// "ERROR UNAVAILABLE". Requests of one connection are answered in order.
+//
+// One thread runs an epoll loop over the listening socket and all
+// connections, and hands complete requests to SERVER_WORKERS worker
+// threads. A worker runs the command holding the table locks it needs
+// (see batchCommandTables), so lookups run in parallel with each other
+// and with changes to unrelated tables, and journals it like the menu.
+// SIGINT or SIGTERM stops the server; the tables are then saved as on
+// exit from the menu.
+
+// Big-endian 32-bit frame length
+static uint32_t readFrameLength(const char *p) {
+    const unsigned char *bytes = (const unsigned char *)p;
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
 
-    Student *current = *studentHead;
-    Student *prev = NULL;
-    while (current != NULL && current->studentId != studentId) {
-        prev = current;
-        current = current->next;
-    }
+static void writeFrameLength(char *p, uint32_t length) {
+    p[0] = (char)(length >> 24);
+    p[1] = (char)(length >> 16);
+    p[2] = (char)(length >> 8);
+    p[3] = (char)length;
+}
 
-    if (!current) {
-        printf("Student with ID %d not found.\n", studentId);
-        return;
+// Create the listening socket. A leftover socket file is replaced: the
+// data file lock guarantees no other server is using it. Returns the
+// socket or -1.
+int serverListen(const char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socketPath);
+        return -1;
     }
+    strcpy(address.sun_path, socketPath);
 
-    if (prev == NULL) {
-        *studentHead = current->next; // Deleting the head
-    } else {
-        prev->next = current->next;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("Error creating socket");
+        return -1;
     }
-
-    free(current); 
-
-    printf("Student with ID %d deleted successfully.\n", studentId);
+    unlink(socketPath);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error listening on %s: %s\n", socketPath, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
 }
 
-// Delete a student by Name
-void deleteStudentByName(Student **studentHead, BookLoan *loanHead) {
-    char studentName[MAX_NAME_LEN];
-    printf("Enter Student Name to delete: ");
-    fgets(studentName, sizeof(studentName), stdin);
-    studentName[strcspn(studentName, "\n")] = 0; 
-
-    Student *current = *studentHead;
-    Student *prev = NULL;
-    while (current != NULL && strcmp(current->studentName, studentName) != 0) {
-        prev = current;
-        current = current->next;
+// Accept every pending connection and watch it for requests
+void serverAccept(Server *server, int epollFd, int listenFd) {
+    for (;;) {
+        int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                perror("Error accepting connection");
+            }
+            if (errno != EINTR && errno != ECONNABORTED) {
+                return;
+            }
+            continue;
+        }
+        Connection *conn = (Connection *)calloc(1, sizeof(Connection));
+        if (!conn) {
+            perror("Memory allocation failed");
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        struct epoll_event event = { EPOLLIN, { .ptr = conn } };
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            perror("Error watching connection");
+            close(fd);
+            free(conn);
+            continue;
+        }
+        conn->next = server->connections;
+        if (server->connections) {
+            server->connections->prev = conn;
+        }
+        server->connections = conn;
     }
+}
 
-    if (!current) {
-        printf("Student with name '%s' not found.\n", studentName);
-        return;
+// Read what the client has sent, as far as the input buffer has room
+void serverRead(Connection *conn) {
+    while (conn->inSize < sizeof(conn->in)) {
+        ssize_t received = recv(conn->fd, conn->in + conn->inSize, sizeof(conn->in) - conn->inSize, 0);
+        if (received > 0) {
+            conn->inSize += (size_t)received;
+        } else if (received == 0) {
+            conn->closing = 1; // No more requests, pending ones are still answered
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                conn->closing = 1;
+            }
+            return;
+        }
     }
+}
 
-    // Check if the student has any active loans
-    if (getLoanCountForStudent(loanHead, current->studentId) > 0) {
-        printf("Cannot delete student with active book loans.\n");
-        return;
+// Send as much of the pending response as the socket takes. A response
+// that cannot be delivered is dropped.
+void serverWrite(Connection *conn) {
+    while (conn->outSent < conn->outSize) {
+        ssize_t sent = send(conn->fd, conn->out + conn->outSent, conn->outSize - conn->outSent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn->outSent += (size_t)sent;
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (sent == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                conn->closing = 1;
+                conn->outSent = conn->outSize;
+            }
+            return;
+        }
     }
+}
 
-
-    if (prev == NULL) {
-        *studentHead = current->next; // Deleting the head
+// Hand the next complete request of an idle connection to the workers.
+// Returns 1 if a request was queued. An oversized frame closes the
+// connection.
+int serverDispatch(Server *server, Connection *conn) {
+    if (conn->inSize < 4) {
+        return 0;
+    }
+    uint32_t length = readFrameLength(conn->in);
+    if (length > SERVER_MAX_REQUEST) {
+        conn->closing = 1;
+        conn->inSize = 0;
+        return 0;
+    }
+    if (conn->inSize < 4 + (size_t)length) {
+        return 0;
+    }
+    memcpy(conn->request, conn->in + 4, length);
+    conn->request[length] = '\0';
+    conn->inSize -= 4 + (size_t)length;
+    memmove(conn->in, conn->in + 4 + length, conn->inSize);
+
+    conn->busy = 1;
+    conn->nextJob = NULL;
+    pthread_mutex_lock(&server->queueLock);
+    if (server->queueTail) {
+        server->queueTail->nextJob = conn;
     } else {
-        prev->next = current->next;
+        server->queueHead = conn;
     }
-
-    free(current); 
-
-    printf("Student with name '%s' deleted successfully.\n", studentName);
+    server->queueTail = conn;
+    pthread_cond_signal(&server->queueReady);
+    pthread_mutex_unlock(&server->queueLock);
+    return 1;
 }
 
+// Move a connection on after it was read from, written to or answered:
+// queue its next request once the previous response is sent, close it
+// once it is idle and closing, and watch for what it is waiting on. The
+// response fields are left alone while a worker owns them.
+void serverUpdate(Server *server, int epollFd, Connection *conn) {
+    if (!conn->busy && conn->outSent == conn->outSize) {
+        conn->outSize = 0;
+        conn->outSent = 0;
+        if (!serverDispatch(server, conn) && conn->closing) {
+            serverClose(server, conn);
+            return;
+        }
+    }
 
-// Update student information
-void updateStudent(Student *studentHead) {
-    int studentId;
-    printf("Enter Student ID to update: ");
-    scanf("%d", &studentId);
-    getchar(); 
-
-    Student *student = findStudentById(studentHead, studentId);
-    if (!student) {
-        printf("Student with ID %d not found.\n", studentId);
+    uint32_t events = 0;
+    if (!conn->closing && conn->inSize < sizeof(conn->in)) {
+        events |= EPOLLIN;
+    }
+    if (!conn->busy && conn->outSent < conn->outSize) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn->events) {
         return;
     }
-
-    printf("Enter new Student Name (leave blank to keep current '%s'): ", student->studentName);
-    char newStudentName[MAX_NAME_LEN];
-    fgets(newStudentName, sizeof(newStudentName), stdin);
-    newStudentName[strcspn(newStudentName, "\n")] = 0; 
-    if (strlen(newStudentName) > 0) {
-        strcpy(student->studentName, newStudentName);
+    if (events == 0) {
+        // A peer that hung up keeps reporting EPOLLHUP, so stop watching
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+    } else {
+        struct epoll_event event = { events, { .ptr = conn } };
+        epoll_ctl(epollFd, conn->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, conn->fd, &event);
     }
+    conn->events = events;
+}
 
-    printf("Student with ID %d updated successfully.\n", studentId);
+// Close and free an idle connection (closing the fd removes it from epoll)
+void serverClose(Server *server, Connection *conn) {
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        server->connections = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    close(conn->fd);
+    free(conn);
 }
 
-// Print all students
-void printStudents(Student *studentHead) {
-    if (!studentHead) {
-        printf("No students in the system.\n");
-        return;
+// Send the responses the workers have finished and move their
+// connections on
+void serverCollect(Server *server, int epollFd) {
+    uint64_t count;
+    if (read(server->wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        perror("Error reading server eventfd");
     }
-    printf("\n--- Students ---\n");
-    printf("ID | Student Name%*s | Penalty Days\n", MAX_NAME_LEN - 12, "");
-    printf("---|-------------%*s|--------------\n", MAX_NAME_LEN - 12, "");
-    Student *temp = studentHead;
-    while (temp != NULL) {
-        printf("%-2d | %-*s | %d\n", temp->studentId, MAX_NAME_LEN - 1, temp->studentName, temp->penaltyDays);
-        temp = temp->next;
+    pthread_mutex_lock(&server->queueLock);
+    Connection *answered = server->answered;
+    server->answered = NULL;
+    pthread_mutex_unlock(&server->queueLock);
+
+    while (answered) {
+        Connection *conn = answered;
+        answered = conn->nextJob;
+        conn->busy = 0;
+        serverWrite(conn);
+        serverUpdate(server, epollFd, conn);
     }
-    printf("----------------\n");
 }
 
-// Find a student by ID
-Student *findStudentById(Student *studentHead, int studentId) {
-    Student *temp = studentHead;
-    while (temp != NULL) {
-        if (temp->studentId == studentId) {
-            return temp;
+// Worker thread: run queued requests against the tables until the
+// server stops and the queue is empty
+void *serverWorker(void *arg) {
+    Server *server = (Server *)arg;
+    for (;;) {
+        pthread_mutex_lock(&server->queueLock);
+        while (!server->queueHead && !server->stopping) {
+            pthread_cond_wait(&server->queueReady, &server->queueLock);
+        }
+        Connection *conn = server->queueHead;
+        if (conn) {
+            server->queueHead = conn->nextJob;
+            if (!server->queueHead) {
+                server->queueTail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&server->queueLock);
+        if (!conn) {
+            return NULL;
+        }
+
+        // The first request after midnight runs the penalty tick
+        if (penaltyTickDue()) {
+            lockTables(TABLE_LOANS, TABLE_STUDENTS);
+            if (penaltyTickDue()) {
+                runPenaltyTick(currentDay());
+            }
+            unlockTables(TABLE_LOANS | TABLE_STUDENTS);
+            journalCommit(0);
+        }
+
+        char detail[MAX_LINE_LEN];
+        unsigned readTables, writeTables;
+        batchCommandTables(conn->request, &readTables, &writeTables);
+        lockTables(readTables, writeTables);
+        int status = runBatchCommand(conn->request, detail, sizeof(detail), &server->bookHead, &server->authorHead,
+                                     &server->studentHead, &server->loanHead, &server->bookAuthorArray,
+                                     &server->bookAuthorCount);
+        unlockTables(readTables | writeTables);
+        // A borrow changes loans under a read lock, so commit after every
+        // request; with nothing logged this only takes journalLock
+        journalCommit(0);
+
+        // A checkpoint takes every table exclusively, so no change and no
+        // second checkpoint can run while it saves
+        if (journalCheckpointDue()) {
+            lockTables(0, TABLE_ALL);
+            if (journalCheckpointDue()) {
+                checkpointTables(server->bookHead, server->authorHead, server->studentHead, &server->loanHead,
+                                 server->bookAuthorArray, server->bookAuthorCount);
+            }
+            unlockTables(TABLE_ALL);
+        }
+
+        size_t length = formatBatchResult(conn->out + 4, sizeof(conn->out) - 4, status, detail);
+        writeFrameLength(conn->out, (uint32_t)length);
+        conn->outSize = 4 + length;
+        conn->outSent = 0;
+
+        pthread_mutex_lock(&server->queueLock);
+        conn->nextJob = server->answered;
+        server->answered = conn;
+        pthread_mutex_unlock(&server->queueLock);
+        uint64_t one = 1;
+        if (write(server->wakeFd, &one, sizeof(one)) < 0) {
+            perror("Error signalling server eventfd");
         }
-        temp = temp->next;
     }
-    return NULL; // Not found
 }
 
-// Find a student by name
-Student *findStudentByName(Student *studentHead, const char *studentName) {
-    Student *temp = studentHead;
-    while (temp != NULL) {
-        if (strcmp(temp->studentName, studentName) == 0) {
-            return temp;
+// Serve clients on socketPath until SIGINT or SIGTERM. The table heads
+// are updated on return. Returns the process exit status.
+int runServer(const char *socketPath, Book **bookHead, Author **authorHead, Student **studentHead,
+              BookLoan **loanHead, BookAuthor **bookAuthorArray, int *bookAuthorCount) {
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.bookHead = *bookHead;
+    server.authorHead = *authorHead;
+    server.studentHead = *studentHead;
+    server.loanHead = *loanHead;
+    server.bookAuthorArray = *bookAuthorArray;
+    server.bookAuthorCount = *bookAuthorCount;
+    pthread_mutex_init(&server.queueLock, NULL);
+    pthread_cond_init(&server.queueReady, NULL);
+
+    // Stop signals are read from a signalfd; block them before the
+    // workers start so that they inherit the mask
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+
+    int listenFd = serverListen(socketPath);
+    int signalFd = signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+    server.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event listenEvent = { EPOLLIN, { .ptr = &listenFd } };
+    struct epoll_event signalEvent = { EPOLLIN, { .ptr = &signalFd } };
+    struct epoll_event wakeEvent = { EPOLLIN, { .ptr = &server.wakeFd } };
+    int status = 0;
+    if (listenFd < 0 || signalFd < 0 || server.wakeFd < 0 || epollFd < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &signalEvent) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, server.wakeFd, &wakeEvent) != 0) {
+        if (listenFd >= 0) {
+            perror("Error starting server");
         }
-        temp = temp->next;
+        status = 2;
     }
-    return NULL; // Not found
-}
 
-// Print information for a specific student
-void printStudentInfo(Student *studentHead, BookLoan *loanHead) {
-    int studentId;
-    printf("Enter Student ID to view info: ");
-    scanf("%d", &studentId);
-    getchar(); 
+    pthread_t workers[SERVER_WORKERS];
+    int workerCount = 0;
+    while (status == 0 && workerCount < SERVER_WORKERS &&
+           pthread_create(&workers[workerCount], NULL, serverWorker, &server) == 0) {
+        workerCount++;
+    }
+    if (status == 0 && workerCount == 0) {
+        perror("Error starting server workers");
+        status = 2;
+    }
+    if (status == 0) {
+        fprintf(stderr, "Serving on %s with %d workers.\n", socketPath, workerCount);
+    }
 
-    Student *student = findStudentById(studentHead, studentId);
-    if (!student) {
-        printf("Student with ID %d not found.\n", studentId);
-        return;
+    // Event loop. The timeout makes sure journal records written by the
+    // last requests are synced even when no more requests arrive.
+    time_t lastCommit = time(NULL);
+    int running = status == 0;
+    while (running) {
+        struct epoll_event events[SERVER_MAX_EVENTS];
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, JOURNAL_SYNC_SECONDS * 1000);
+        if (ready < 0 && errno != EINTR) {
+            perror("Error waiting for events");
+            status = 1;
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            void *source = events[i].data.ptr;
+            if (source == &listenFd) {
+                serverAccept(&server, epollFd, listenFd);
+            } else if (source == &signalFd) {
+                // Consume the signal, it would kill the process once unblocked
+                struct signalfd_siginfo info;
+                if (read(signalFd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+                    fprintf(stderr, "Received %s, stopping server.\n", strsignal((int)info.ssi_signo));
+                }
+                running = 0;
+            } else if (source == &server.wakeFd) {
+                serverCollect(&server, epollFd);
+            } else {
+                Connection *conn = (Connection *)source;
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    conn->closing = 1;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    serverRead(conn);
+                }
+                if ((events[i].events & EPOLLOUT) && !conn->busy) {
+                    serverWrite(conn);
+                }
+                serverUpdate(&server, epollFd, conn);
+            }
+        }
+        time_t now = time(NULL);
+        if (now != lastCommit) {
+            journalCommit(0);
+            lastCommit = now;
+        }
     }
 
-    printf("\n--- Student Information ---\n");
-    printf("ID: %d\n", student->studentId);
-    printf("Name: %s\n", student->studentName);
-    printf("Penalty Days: %d\n", student->penaltyDays);
+    // Let the workers finish the queued requests, then drop all clients
+    pthread_mutex_lock(&server.queueLock);
+    server.stopping = 1;
+    pthread_cond_broadcast(&server.queueReady);
+    pthread_mutex_unlock(&server.queueLock);
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    while (server.connections) {
+        serverClose(&server, server.connections);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath);
+    }
+    if (signalFd >= 0) {
+        close(signalFd);
+    }
+    if (server.wakeFd >= 0) {
+        close(server.wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+    pthread_sigmask(SIG_UNBLOCK, &stopSignals, NULL);
+    pthread_cond_destroy(&server.queueReady);
+    pthread_mutex_destroy(&server.queueLock);
+
+    *bookHead = server.bookHead;
+    *authorHead = server.authorHead;
+    *studentHead = server.studentHead;
+    *loanHead = server.loanHead;
+    *bookAuthorArray = server.bookAuthorArray;
+    *bookAuthorCount = server.bookAuthorCount;
+    return status;
+}
 
-    printf("\nActive Loans:\n");
-    printStudentBookLoans(loanHead, studentId);
 
-    printf("---------------------------\n");
-}
+// --- Stress Test Functions ---
+// --stress checks claimBookExample under contention. It uses books of its
+// own, not the library's tables, so it can run next to a server.
+
+// Claim and release random examples of the hot books, counting in holders
+// how many threads hold each example
+void *stressThread(void *arg) {
+    StressJob *job = (StressJob *)arg;
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+        int b = rand_r(&job->seed) % job->bookCount;
+        Book *book = &job->books[b];
+        // Half of the claims ask for a given example, half for any free one
+        int exampleId = 0;
+        if (rand_r(&job->seed) % 2) {
+            exampleId = rand_r(&job->seed) % book->exampleCount + 1;
+        }
+        exampleId = claimBookExample(book, exampleId);
+        if (exampleId == 0) {
+            job->refused++;
+            continue;
+        }
+        job->claims++;
 
-// Print book loans for a specific student
-void printStudentBookLoans(BookLoan *loanHead, int studentId) {
-    int foundLoans = 0;
-    BookLoan *tmp = loanHead;
-    while (tmp != NULL) {
-        if (tmp->studentId == studentId && tmp->returned == 0) {
-            if (!foundLoans) {
-                printf("  Loan ID | Book ID | Example ID | Loan Date | Return Date\n");
-                printf("  --------|---------|------------|-----------|-------------\n");
-                foundLoans = 1;
-            }
-            printf("  %-7d | %-7d | %-10d | %-9s | %-11s\n",
-                   tmp->loanId, tmp->bookId, tmp->exampleId, tmp->loanDate, tmp->returnDate);
+        int *holder = &job->holders[b][exampleId - 1];
+        if (__atomic_fetch_add(holder, 1, __ATOMIC_RELAXED) != 0) {
+            job->errors++; // Lent twice
+        }
+        if (round % 64 == 0) {
+            sched_yield(); // Keep some claims across a reschedule
+        }
+        __atomic_fetch_sub(holder, 1, __ATOMIC_RELAXED);
+        if (releaseBookExample(book, exampleId) != 0) {
+            job->errors++;
         }
-        tmp = tmp->next;
-    }
-    if (!foundLoans) {
-        printf("  No active loans for this student.\n");
     }
+    return NULL;
 }
 
-// Print students with penalty days
-void printStudentsWithPenalty(Student *studentHead) {
-    printf("\n--- Students with Penalty ---\n");
-    printf("ID | Student Name%*s | Penalty Days\n", MAX_NAME_LEN - 12, "");
-    printf("---|-------------%*s|--------------\n", MAX_NAME_LEN - 12, "");
+// Hammer a few hot books from STRESS_THREADS threads and check that no
+// example is ever held by two threads at once and that every example is
+// back on the shelf at the end. Returns 0 if so, 1 otherwise.
+int runStress() {
+    static const int exampleCounts[] = { 1, 2, 5, 130 }; // The last one has an out-of-line bitmap
+    enum { BOOK_COUNT = sizeof(exampleCounts) / sizeof(exampleCounts[0]) };
+    Book books[BOOK_COUNT];
+    int *holders[BOOK_COUNT];
+    memset(books, 0, sizeof(books));
+    for (int i = 0; i < BOOK_COUNT; i++) {
+        holders[i] = (int *)calloc(exampleCounts[i], sizeof(int));
+        if (!holders[i] || createBookExamples(&books[i], exampleCounts[i]) != 0) {
+            perror("Memory allocation failed");
+            return 1;
+        }
+    }
 
-    Student *temp = studentHead;
-    int foundPenalty = 0;
-    while (temp != NULL) {
-        if (temp->penaltyDays > 0) {
-            printf("%-2d | %-*s | %d\n", temp->studentId, MAX_NAME_LEN - 1, temp->studentName, temp->penaltyDays);
-            foundPenalty = 1;
+    StressJob jobs[STRESS_THREADS];
+    pthread_t threads[STRESS_THREADS];
+    int started[STRESS_THREADS];
+    struct timespec startTime, endTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        StressJob job = { books, BOOK_COUNT, holders, (unsigned)i + 1, 0, 0, 0 };
+        jobs[i] = job;
+        started[i] = pthread_create(&threads[i], NULL, stressThread, &jobs[i]) == 0;
+        if (!started[i]) {
+            stressThread(&jobs[i]);
         }
-        temp = temp->next;
     }
+    long claims = 0, refused = 0, errors = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        claims += jobs[i].claims;
+        refused += jobs[i].refused;
+        errors += jobs[i].errors;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
 
-    if (!foundPenalty) {
-        printf("No students currently have penalty days.\n");
+    for (int i = 0; i < BOOK_COUNT; i++) {
+        for (int exampleId = 1; exampleId <= books[i].exampleCount; exampleId++) {
+            if (getBookExampleStatus(&books[i], exampleId) != 0) {
+                errors++;
+            }
+        }
+        if (books[i].availableCount != books[i].exampleCount) {
+            errors++;
+        }
+        freeBookExamples(&books[i]);
+        free(holders[i]);
     }
-    printf("-----------------------------\n");
-}
 
+    double seconds = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+    printf("Stress: %d threads, %ld claims, %ld refused, %ld errors in %.2f s\n",
+           STRESS_THREADS, claims, refused, errors, seconds);
+    return errors == 0 ? 0 : 1;
+}
 
 // --- Main Function and Menu ---
 
-int main() {
+int main(int argc, char *argv[]) {
+    const char *batchFile = NULL;
+    const char *socketPath = NULL;
+    if (argc == 3 && strcmp(argv[1], "--batch") == 0) {
+        batchFile = argv[2];
+    } else if ((argc == 2 || argc == 3) && strcmp(argv[1], "--serve") == 0) {
+        socketPath = argc == 3 ? argv[2] : SERVER_SOCKET;
+    } else if (argc == 2 && strcmp(argv[1], "--stress") == 0) {
+        return runStress();
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--batch FILE|- | --serve [SOCKET] | --stress]\n", argv[0]);
+        return 2;
+    }
+    if (lockDataFiles() != 0) {
+        return 2;
+    }
+
     Book *bookHead = NULL;
     Author *authorHead = NULL;
     Student *studentHead = NULL;
@@ -1482,19 +8441,39 @@ int main() {
     BookAuthor *bookAuthorArray = NULL;
     int bookAuthorCount = 0;
 
-    // Load data from CSV files
-    loadBooks(&bookHead);
-    loadAuthors(&authorHead);
-    loadStudents(&studentHead);
-    loadBookLoans(&loanHead);
-    loadBookAuthors(&bookAuthorArray, &bookAuthorCount);
+    // Load the binary snapshot when it is current, otherwise import the CSV files
+    if (!snapshotIsCurrent() ||
+        loadSnapshot(&bookHead, &authorHead, &studentHead, &loanHead, &bookAuthorArray, &bookAuthorCount) != 0) {
+        loadTables(NULL, &bookHead, &authorHead, &studentHead, &loanHead, &bookAuthorArray, &bookAuthorCount);
+        loadSequences();
+    }
+    linkTables(bookHead, bookAuthorArray, bookAuthorCount);
+    // Changes made after the last checkpoint
+    journalReplay(&bookHead, &authorHead, &studentHead, &loanHead, &bookAuthorArray, &bookAuthorCount);
+    // Late days since the last run
+    runPenaltyTick(currentDay());
+
+    if (batchFile || socketPath) {
+        int status = batchFile ?
+            runBatch(batchFile, &bookHead, &authorHead, &studentHead, &loanHead, &bookAuthorArray, &bookAuthorCount) :
+            runServer(socketPath, &bookHead, &authorHead, &studentHead, &loanHead, &bookAuthorArray, &bookAuthorCount);
+        closeLibrary(bookHead, authorHead, studentHead, loanHead, bookAuthorArray, bookAuthorCount);
+        return status;
+    }
 
     int choice;
     do {
         printMenu();
         printf("Enter your choice: ");
-        scanf("%d", &choice);
+        if (scanf("%d", &choice) != 1) {
+            // End of input exits (and saves); a line that is not a number is skipped
+            choice = feof(stdin) ? 0 : -1;
+            scanf("%*[^\n]");
+        }
         getchar(); 
+        if (penaltyTickDue()) {
+            runPenaltyTick(currentDay());
+        }
 
         switch (choice) {
             case 1: // Book Operations
@@ -1507,7 +8486,9 @@ int main() {
                 printf("6. List Book Examples (By Book Name)\n");
                 printf("7. Find Book by Name\n");
                 printf("8. Find Book by ISBN\n");
-                printf("9. Back to Main Menu\n");
+                printf("9. List Authors of a Book\n");
+                printf("10. Search Books by Title or Author Words\n");
+                printf("11. Back to Main Menu\n");
                 printf("Enter your choice: ");
                 int bookChoice;
                 scanf("%d", &bookChoice);
@@ -1515,7 +8496,7 @@ int main() {
 
                 switch (bookChoice) {
                     case 1: addBook(&bookHead); break;
-                    case 2: deleteBook(&bookHead, loanHead); break;
+                    case 2: deleteBook(&bookHead, &bookAuthorArray, &bookAuthorCount); break;
                     case 3: updateBook(bookHead); break;
                     case 4: printBooks(bookHead); break;
                     case 5: printBookExamples(bookHead); break;
@@ -1525,12 +8506,7 @@ int main() {
                         printf("Enter Book Name to find: ");
                         fgets(bookName, sizeof(bookName), stdin);
                         bookName[strcspn(bookName, "\n")] = 0;
-                        Book *foundBook = findBookByName(bookHead, bookName);
-                        if (foundBook) {
-                            printf("Book Found: ID %d, Name: %s, ISBN: %s\n", foundBook->bookId, foundBook->bookName, foundBook->ISBN);
-                        } else {
-                            printf("Book '%s' not found.\n", bookName);
-                        }
+                        searchBooksByName(bookHead, bookName);
                         break;
                     }
                     case 8: {
@@ -1546,7 +8522,23 @@ int main() {
                          }
                          break;
                     }
-                    case 9: break; 
+                    case 9: {
+                        int bookId;
+                        printf("Enter Book ID: ");
+                        scanf("%d", &bookId);
+                        getchar();
+                        printAuthorsOfBook(bookAuthorArray, bookAuthorCount, bookId);
+                        break;
+                    }
+                    case 10: {
+                        char query[MAX_LINE_LEN];
+                        printf("Enter words to search: ");
+                        fgets(query, sizeof(query), stdin);
+                        query[strcspn(query, "\n")] = 0;
+                        searchBooksByWords(bookHead, authorHead, bookAuthorArray, bookAuthorCount, query);
+                        break;
+                    }
+                    case 11: break; 
                     default: printf("Invalid choice.\n");
                 }
                 break;
@@ -1558,7 +8550,8 @@ int main() {
                  printf("3. Update Author\n");
                  printf("4. List All Authors\n");
                  printf("5. Find Author by Name\n");
-                 printf("6. Back to Main Menu\n");
+                 printf("6. List Books by an Author\n");
+                 printf("7. Back to Main Menu\n");
                  printf("Enter your choice: ");
                  int authorChoice;
                  scanf("%d", &authorChoice);
@@ -1581,15 +8574,18 @@ int main() {
                          printf("Enter Author Name to find: ");
                          fgets(authorName, sizeof(authorName), stdin);
                          authorName[strcspn(authorName, "\n")] = 0;
-                         Author *foundAuthor = findAuthorByName(authorHead, authorName);
-                         if (foundAuthor) {
-                             printf("Author Found: ID %d, Name: %s\n", foundAuthor->authorId, foundAuthor->authorName);
-                         } else {
-                             printf("Author '%s' not found.\n", authorName);
-                         }
+                         searchAuthorsByName(authorHead, authorName);
+                         break;
+                     }
+                     case 6: {
+                         int authorId;
+                         printf("Enter Author ID: ");
+                         scanf("%d", &authorId);
+                         getchar();
+                         printBooksByAuthor(bookAuthorArray, bookAuthorCount, authorId);
                          break;
                      }
-                     case 6: break;
+                     case 7: break;
                      default: printf("Invalid choice.\n");
                  }
                  break;
@@ -1612,8 +8608,8 @@ int main() {
 
                  switch (studentChoice) {
                      case 1: addStudent(&studentHead); break;
-                     case 2: deleteStudentById(&studentHead, loanHead); break;
-                     case 3: deleteStudentByName(&studentHead, loanHead); break;
+                     case 2: deleteStudentById(&studentHead); break;
+                     case 3: deleteStudentByName(&studentHead); break;
                      case 4: updateStudent(studentHead); break;
                      case 5: printStudents(studentHead); break;
                       case 6: {
@@ -1621,12 +8617,7 @@ int main() {
                          printf("Enter Student Name to find: ");
                          fgets(studentName, sizeof(studentName), stdin);
                          studentName[strcspn(studentName, "\n")] = 0;
-                         Student *foundStudent = findStudentByName(studentHead, studentName);
-                         if (foundStudent) {
-                             printf("Student Found: ID %d, Name: %s, Penalty Days: %d\n", foundStudent->studentId, foundStudent->studentName, foundStudent->penaltyDays);
-                         } else {
-                             printf("Student '%s' not found.\n", studentName);
-                         }
+                         searchStudentsByName(studentHead, studentName);
                          break;
                      }
                      case 7: printStudentInfo(studentHead, loanHead); break;
@@ -1642,7 +8633,10 @@ int main() {
                 printf("2. Return Book\n");
                 printf("3. List All Book Loans\n");
                 printf("4. List Overdue Loans\n");
-                printf("5. Back to Main Menu\n");
+                printf("5. Student Loan History\n");
+                printf("6. Book Example Loan History\n");
+                printf("7. List Loans Due Within N Days\n");
+                printf("8. Back to Main Menu\n");
                 printf("Enter your choice: ");
                 int loanChoice;
                 scanf("%d", &loanChoice);
@@ -1653,7 +8647,34 @@ int main() {
                     case 2: returnBook(&loanHead, bookHead); break;
                     case 3: printBookLoans(loanHead); break;
                     case 4: printOverdueLoans(loanHead); break;
-                    case 5: break; 
+                    case 5: {
+                        int studentId;
+                        printf("Enter Student ID: ");
+                        scanf("%d", &studentId);
+                        getchar();
+                        printStudentLoanHistory(studentId);
+                        break;
+                    }
+                    case 6: {
+                        int bookId, exampleId;
+                        printf("Enter Book ID: ");
+                        scanf("%d", &bookId);
+                        getchar();
+                        printf("Enter Example ID: ");
+                        scanf("%d", &exampleId);
+                        getchar();
+                        printExampleLoanHistory(bookId, exampleId);
+                        break;
+                    }
+                    case 7: {
+                        int days;
+                        printf("Enter Number of Days: ");
+                        scanf("%d", &days);
+                        getchar();
+                        printLoansDueWithin(loanHead, days);
+                        break;
+                    }
+                    case 8: break; 
                     default: printf("Invalid choice.\n");
                 }
                 break;
@@ -1677,7 +8698,12 @@ int main() {
                          printf("Enter Author ID: ");
                          scanf("%d", &authorId);
                          getchar();
-                         addBookAuthor(&bookAuthorArray, &bookAuthorCount, bookId, authorId);
+                         int linkStatus = addBookAuthor(&bookAuthorArray, &bookAuthorCount, bookId, authorId);
+                         if (linkStatus == OP_DUPLICATE) {
+                             printf("This book-author link already exists.\n");
+                         } else if (linkStatus == OP_OK) {
+                             printf("Book-author link added successfully.\n");
+                         }
                          break;
                      }
                      case 2: printBookAuthors(bookAuthorArray, bookAuthorCount); break;
@@ -1689,25 +8715,21 @@ int main() {
 
             case 0: // Exit
                 printf("Exiting program. Saving data...\n");
-                saveBooks(bookHead);
-                saveAuthors(authorHead);
-                saveStudents(studentHead);
-                saveBookLoans(loanHead);
-                saveBookAuthors(bookAuthorArray, bookAuthorCount);
-
-                // Free allocated memory
-                freeBooks(bookHead);
-                freeAuthors(authorHead);
-                freeStudents(studentHead);
-                freeBookLoans(loanHead);
-                free(bookAuthorArray); // Free the dynamic array
-
+                closeLibrary(bookHead, authorHead, studentHead, loanHead, bookAuthorArray, bookAuthorCount);
                 printf("Data saved and memory freed. Goodbye!\n");
                 break;
 
             default:
                 printf("Invalid choice. Please try again.\n");
         }
+
+        // Persist the changes made by this choice
+        if (choice != 0) {
+            journalCommit(0);
+            if (journalCheckpointDue()) {
+                checkpointTables(bookHead, authorHead, studentHead, &loanHead, bookAuthorArray, bookAuthorCount);
+            }
+        }
     } while (choice != 0);
 
     return 0;
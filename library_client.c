@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Client of `library --serve`. Sends batch commands over the server's
+// Unix domain socket and prints the responses, or with --bench measures
+// the server's throughput and latency. Frames on the socket are a 4-byte
+// big-endian payload length followed by the payload.
+
+#define DEFAULT_SOCKET "kutuphane.sock"
+#define MAX_REQUEST 1024 // Longest request the server accepts
+#define MAX_RESPONSE 1024
+#define MAX_BENCH_CONNECTIONS 1024
+
+// One connection of the load generator
+typedef struct BenchWorker {
+    const char *socketPath;
+    char **commands; // Sent in turn, starting at offset
+    size_t commandCount;
+    size_t offset;
+    long requests;
+    uint64_t *latencies; // Nanoseconds per request
+    long errors; // ERROR responses
+    int failed; // Connection failed
+} BenchWorker;
+
+// Function prototypes
+int connectServer(const char *socketPath);
+int sendAll(int fd, const char *data, size_t size);
+int recvAll(int fd, char *data, size_t size);
+int roundTrip(int fd, const char *request, char *response, size_t responseSize);
+int runCommands(const char *socketPath, int argc, char *argv[]);
+int loadCommands(const char *fileName, char ***commands, size_t *count);
+void *benchThread(void *arg);
+int compareLatency(const void *a, const void *b);
+int runBench(const char *socketPath, int connections, long requests, const char *commandFile);
+void printUsage(const char *program);
+
+
+// Connect to the server. Returns the socket or -1.
+int connectServer(const char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("Error creating socket");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "Error connecting to %s: %s\n", socketPath, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Write the whole buffer. Returns 0 on success, -1 on error.
+int sendAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return -1;
+        }
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return 0;
+}
+
+// Read exactly size bytes. Returns 0 on success, -1 on error or EOF.
+int recvAll(int fd, char *data, size_t size) {
+    while (size > 0) {
+        ssize_t received = recv(fd, data, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return -1;
+        }
+        data += received;
+        size -= (size_t)received;
+    }
+    return 0;
+}
+
+// Send one request and wait for its response, which is stored null
+// terminated (and truncated to fit). Returns 0 on success, -1 if the
+// connection failed.
+int roundTrip(int fd, const char *request, char *response, size_t responseSize) {
+    size_t length = strlen(request);
+    if (length > MAX_REQUEST) {
+        fprintf(stderr, "Request longer than %d bytes\n", MAX_REQUEST);
+        return -1;
+    }
+    char frame[4 + MAX_REQUEST];
+    frame[0] = (char)(length >> 24);
+    frame[1] = (char)(length >> 16);
+    frame[2] = (char)(length >> 8);
+    frame[3] = (char)length;
+    memcpy(frame + 4, request, length);
+    if (sendAll(fd, frame, 4 + length) != 0) {
+        return -1;
+    }
+
+    unsigned char header[4];
+    if (recvAll(fd, (char *)header, sizeof(header)) != 0) {
+        return -1;
+    }
+    size_t responseLength = (size_t)header[0] << 24 | (size_t)header[1] << 16 | (size_t)header[2] << 8 | header[3];
+    char buffer[MAX_RESPONSE];
+    if (responseLength > sizeof(buffer) || recvAll(fd, buffer, responseLength) != 0) {
+        return -1;
+    }
+    if (responseLength >= responseSize) {
+        responseLength = responseSize - 1;
+    }
+    memcpy(response, buffer, responseLength);
+    response[responseLength] = '\0';
+    return 0;
+}
+
+// Send the command given by the arguments, or else every non-blank line
+// of stdin, and print the responses. Returns the exit status: 0 if every
+// response was OK, 1 if any was an error, 2 if the connection failed.
+int runCommands(const char *socketPath, int argc, char *argv[]) {
+    int fd = connectServer(socketPath);
+    if (fd < 0) {
+        return 2;
+    }
+
+    int status = 0;
+    char response[MAX_RESPONSE];
+    if (argc > 0) {
+        char request[MAX_REQUEST + 1] = "";
+        size_t length = 0;
+        for (int i = 0; i < argc; i++) {
+            int written = snprintf(request + length, sizeof(request) - length, "%s%s", i ? " " : "", argv[i]);
+            if (written < 0 || (size_t)written >= sizeof(request) - length) {
+                fprintf(stderr, "Request longer than %d bytes\n", MAX_REQUEST);
+                close(fd);
+                return 2;
+            }
+            length += (size_t)written;
+        }
+        if (roundTrip(fd, request, response, sizeof(response)) != 0) {
+            fprintf(stderr, "Connection to the server failed\n");
+            status = 2;
+        } else {
+            printf("%s\n", response);
+            status = strncmp(response, "OK", 2) == 0 ? 0 : 1;
+        }
+        close(fd);
+        return status;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, stdin) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0') {
+            continue;
+        }
+        if (roundTrip(fd, line, response, sizeof(response)) != 0) {
+            fprintf(stderr, "Connection to the server failed\n");
+            status = 2;
+            break;
+        }
+        printf("%s\n", response);
+        if (strncmp(response, "OK", 2) != 0) {
+            status = 1;
+        }
+    }
+    free(line);
+    close(fd);
+    return status;
+}
+
+// Read the non-blank lines of a command file. Returns 0 on success.
+int loadCommands(const char *fileName, char ***commands, size_t *count) {
+    FILE *file = fopen(fileName, "r");
+    if (!file) {
+        perror("Error opening command file");
+        return -1;
+    }
+    size_t capacity = 0;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    *commands = NULL;
+    *count = 0;
+    while (getline(&line, &lineCapacity, file) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0' || line[0] == '#') {
+            continue;
+        }
+        if (*count == capacity) {
+            size_t newCapacity = capacity ? capacity * 2 : 64;
+            char **grown = (char **)realloc(*commands, sizeof(char *) * newCapacity);
+            if (!grown) {
+                perror("Memory allocation failed");
+                break;
+            }
+            *commands = grown;
+            capacity = newCapacity;
+        }
+        (*commands)[*count] = strdup(line);
+        if (!(*commands)[*count]) {
+            perror("Memory allocation failed");
+            break;
+        }
+        (*count)++;
+    }
+    free(line);
+    fclose(file);
+    return *count > 0 ? 0 : -1;
+}
+
+// Thread entry: send one BenchWorker's requests back to back on its own
+// connection and time each of them
+void *benchThread(void *arg) {
+    BenchWorker *worker = (BenchWorker *)arg;
+    int fd = connectServer(worker->socketPath);
+    if (fd < 0) {
+        worker->failed = 1;
+        return NULL;
+    }
+    char response[MAX_RESPONSE];
+    for (long i = 0; i < worker->requests; i++) {
+        const char *command = worker->commands[(worker->offset + (size_t)i) % worker->commandCount];
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (roundTrip(fd, command, response, sizeof(response)) != 0) {
+            worker->failed = 1;
+            worker->requests = i;
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        worker->latencies[i] = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000u + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+        if (strncmp(response, "OK", 2) != 0) {
+            worker->errors++;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+// qsort comparison of latencies
+int compareLatency(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Send requests from several connections at once and report throughput
+// and latency percentiles. Returns the exit status.
+int runBench(const char *socketPath, int connections, long requests, const char *commandFile) {
+    static char *pingCommand[] = { "PING" };
+    char **commands = pingCommand;
+    size_t commandCount = 1;
+    if (commandFile && loadCommands(commandFile, &commands, &commandCount) != 0) {
+        fprintf(stderr, "No commands in %s\n", commandFile);
+        return 2;
+    }
+
+    BenchWorker *workers = (BenchWorker *)calloc((size_t)connections, sizeof(BenchWorker));
+    pthread_t *threads = (pthread_t *)calloc((size_t)connections, sizeof(pthread_t));
+    uint64_t *latencies = (uint64_t *)malloc(sizeof(uint64_t) * (size_t)requests);
+    if (!workers || !threads || !latencies) {
+        perror("Memory allocation failed");
+        return 2;
+    }
+
+    // Split the requests evenly; each connection starts at its own place
+    // in the command list so that they do not all send the same command
+    long assigned = 0;
+    for (int i = 0; i < connections; i++) {
+        workers[i].socketPath = socketPath;
+        workers[i].commands = commands;
+        workers[i].commandCount = commandCount;
+        workers[i].offset = commandCount * (size_t)i / (size_t)connections;
+        workers[i].requests = requests / connections + (i < requests % connections);
+        workers[i].latencies = latencies + assigned;
+        assigned += workers[i].requests;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int started = 0;
+    for (; started < connections; started++) {
+        if (pthread_create(&threads[started], NULL, benchThread, &workers[started]) != 0) {
+            perror("Error starting client thread");
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // Gather the latencies of completed requests at the front
+    long completed = 0;
+    long errors = 0;
+    int failed = started < connections;
+    for (int i = 0; i < started; i++) {
+        memmove(latencies + completed, workers[i].latencies, sizeof(uint64_t) * (size_t)workers[i].requests);
+        completed += workers[i].requests;
+        errors += workers[i].errors;
+        failed |= workers[i].failed;
+    }
+    qsort(latencies, (size_t)completed, sizeof(uint64_t), compareLatency);
+
+    printf("Requests:   %ld over %d connection(s), %ld error response(s)\n", completed, started, errors);
+    printf("Time:       %.3f s\n", seconds);
+    printf("Throughput: %.0f requests/s\n", seconds > 0 ? completed / seconds : 0.0);
+    if (completed > 0) {
+        printf("Latency:    p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+               latencies[(completed - 1) * 50 / 100] / 1000.0,
+               latencies[(completed - 1) * 99 / 100] / 1000.0,
+               latencies[(completed - 1) * 999 / 1000] / 1000.0,
+               latencies[completed - 1] / 1000.0);
+    }
+
+    free(latencies);
+    free(threads);
+    free(workers);
+    if (commands != pingCommand) {
+        for (size_t i = 0; i < commandCount; i++) {
+            free(commands[i]);
+        }
+        free(commands);
+    }
+    return failed ? 2 : 0;
+}
+
+// Print command line usage
+void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [-s SOCKET] [COMMAND...]\n"
+            "       %s [-s SOCKET] --bench [-c CONNECTIONS] [-n REQUESTS] [-f FILE]\n"
+            "Without COMMAND, sends each line of standard input. --bench sends REQUESTS\n"
+            "requests (default 100000) over CONNECTIONS connections (default 8), taking\n"
+            "the commands from FILE in turn (default PING).\n",
+            program, program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *socketPath = DEFAULT_SOCKET;
+    const char *commandFile = NULL;
+    int bench = 0;
+    int connections = 8;
+    long requests = 100000;
+
+    int i = 1;
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = 1;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            requests = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            commandFile = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            break;
+        }
+    }
+
+    if (!bench) {
+        return runCommands(socketPath, argc - i, argv + i);
+    }
+    if (i < argc || connections < 1 || connections > MAX_BENCH_CONNECTIONS || requests < 1) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    return runBench(socketPath, connections, requests, commandFile);
+}